@@ -3,6 +3,10 @@
 NextionInterface hmi(Serial);
 NextionComponent myComponent(0, 3, "b0");
 
+// Name kept in flash, no heap copy is made
+const char myGaugeName[] PROGMEM = "z0";
+NextionComponent myGauge(0, 4, myGaugeName, NextionComponent::NameStorage::Flash);
+
 void setup() {
   Serial.begin(115200);
   setupHmi();
@@ -44,6 +48,32 @@ void setupHmi() {
     Serial.println(event == NextionConstants::ClickEvent::Released ? "Released" : "Pressed");
   };
 
+  // Needs sendxy=1 on the display, drags are reported at most once per update()
+  hmi.onTouchCoordinate = [](uint16_t x, uint16_t y, NextionConstants::ClickEvent event) {
+    Serial.print(F("Touch at "));
+    Serial.print(x);
+    Serial.print(F(","));
+    Serial.println(y);
+  };
+
+  hmi.onDateTimeReceived = [](const DateTime &dateTime) {
+    Serial.print(F("Date time received: "));
+    Serial.print(dateTime.year);
+    Serial.print(F("-"));
+    Serial.print(dateTime.month);
+    Serial.print(F("-"));
+    Serial.print(dateTime.day);
+    Serial.print(F(" "));
+    Serial.println(hmi.getDayOfTheWeek(static_cast<NextionConstants::DayOfTheWeek>(dateTime.dayOfTheWeek)));
+  };
+
+  hmi.onBaudRateChange = [](uint32_t baudRate) {
+    Serial.flush();
+    Serial.begin(baudRate);
+  };
+
+  hmi.negotiateBaudRate(115200);  // Steps up as far as the link allows, falls back otherwise
+
   hmi.changePage(0);           // Using pageId
   hmi.changePage("pageName");  // Using pageName
 
@@ -62,13 +92,13 @@ void setupHmi() {
 
   hmi.setText(myComponent, "Hello!");
   hmi.setInteger(myComponent, 123);
+  hmi.setInteger(myGauge, 90);
 
   hmi.getText(myComponent);
   hmi.getInteger(myComponent);
 
   hmi.setDate(25, 3, 1992);
   hmi.setTime(4, 17, 58);
-  hmi.getDate();
-  hmi.getTime();
-  hmi.getDayOfTheWeek();
+  // Non-blocking, completes through onDateTimeReceived. getDate() and getTime() fail until it has.
+  hmi.requestDateTime();
 }
@@ -0,0 +1,132 @@
+#include <NextionInterface.h>
+#include <NextionLoopbackStream.h>
+
+// Measures the encode and parse hot paths against an in-memory stream, so the numbers only reflect the
+// library and not the UART. Each line reports operations per second, and for commands the bytes and
+// Stream::write calls each one costs. It also builds and runs on a desktop as the nextion_benchmark target
+// of the CMake host build, to compare releases.
+
+#if defined(__AVR__)
+constexpr uint16_t ITERATIONS = 500;
+constexpr uint16_t STREAM_CAPACITY = 256;
+#else
+constexpr uint16_t ITERATIONS = 20000;
+constexpr uint16_t STREAM_CAPACITY = 1024;
+#endif
+
+// Replies fed at once, each answering a request of its own
+constexpr uint8_t REPLIES_PER_LOAD = 8;
+
+NextionLoopbackStream<STREAM_CAPACITY> stream;
+BasicNextionInterface<NextionConstants::MAX_BUFFER_SIZE, NextionConstants::MAX_FRAME_SIZE, REPLIES_PER_LOAD> hmi(stream);
+NextionComponent number(0, 1, "n0", NextionComponent::NameStorage::Ram);
+NextionComponent text(0, 2, "t0", NextionComponent::NameStorage::Ram);
+NextionComponent button(0, 3, "b0", NextionComponent::NameStorage::Ram);
+
+const uint8_t TOUCH_FRAME[] = { 0x65, 0x00, 0x03, 0x01, 0xFF, 0xFF, 0xFF };
+const uint8_t NUMERIC_FRAME[] = { 0x71, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+const uint8_t STRING_FRAME[] = { 0x70, 'H', 'e', 'l', 'l', 'o', ' ', 'N', 'e', 'x', 't', 'i', 'o', 'n', 0xFF, 0xFF, 0xFF };
+const uint8_t PAGE_ID_FRAME[] = { 0x66, 0x02, 0xFF, 0xFF, 0xFF };
+
+volatile uint32_t touches = 0;
+volatile uint32_t replies = 0;
+
+void setup() {
+  Serial.begin(115200);
+
+  hmi.registerComponent(number);
+  hmi.registerComponent(text);
+  hmi.registerComponent(button);
+  button.onTouchEvent = [](NextionConstants::ClickEvent) {
+    touches++;
+  };
+  number.onNumericDataReceived = [](int32_t) {
+    replies++;
+  };
+  text.onStringDataReceived = [](char *) {
+    replies++;
+  };
+
+  Serial.println(F("benchmark,ops_per_second,bytes_per_op,writes_per_op"));
+
+  benchmarkEncode(F("setText"), [](uint16_t) {
+    hmi.setText(text, "Hello Nextion");
+  });
+  benchmarkEncode(F("setInteger"), [](uint16_t i) {
+    hmi.setInteger(number, -100000 + i);
+  });
+  benchmarkEncode(F("setColor"), [](uint16_t i) {
+    hmi.setBackgroundColor(button, static_cast<uint16_t>(i));
+  });
+  benchmarkEncode(F("click"), [](uint16_t) {
+    hmi.click(button, NextionConstants::ClickEvent::Pressed);
+  });
+  benchmarkEncode(F("convertTextToNumeric"), [](uint16_t) {
+    hmi.convertTextToNumeric(text, number, 5);
+  });
+
+  benchmarkParse(F("parse touch"), TOUCH_FRAME, sizeof(TOUCH_FRAME), nullptr);
+  benchmarkParse(F("parse numeric"), NUMERIC_FRAME, sizeof(NUMERIC_FRAME), []() {
+    hmi.getInteger(number);
+  });
+  benchmarkParse(F("parse string"), STRING_FRAME, sizeof(STRING_FRAME), []() {
+    hmi.getText(text);
+  });
+  benchmarkParse(F("parse page id"), PAGE_ID_FRAME, sizeof(PAGE_ID_FRAME), nullptr);
+}
+
+void loop() {
+}
+
+void benchmarkEncode(const __FlashStringHelper *name, void (*command)(uint16_t)) {
+  stream.clearWritten();
+  const auto startedAt = micros();
+
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    command(i);
+  }
+
+  report(name, micros() - startedAt, ITERATIONS);
+  Serial.print(F(","));
+  Serial.print(static_cast<float>(stream.bytesWritten()) / ITERATIONS);
+  Serial.print(F(","));
+  Serial.println(static_cast<float>(stream.writeCalls()) / ITERATIONS);
+}
+
+// Data replies are only taken for a pending get, so request issues one per reply. Requests are sent
+// outside the timed part, which covers reading the replies and handing them to their components.
+void benchmarkParse(const __FlashStringHelper *name, const uint8_t *frame, uint16_t size, void (*request)()) {
+  unsigned long elapsed = 0;
+  uint32_t parsed = 0;
+
+  while (parsed < ITERATIONS) {
+    uint8_t count = 0;
+
+    while (count < REPLIES_PER_LOAD && stream.feed(frame, size)) {
+      if (request != nullptr) {
+        request();
+      }
+
+      count++;
+    }
+
+    stream.clearWritten();
+    const auto startedAt = micros();
+
+    while (stream.available() > 0) {
+      hmi.update();
+    }
+
+    elapsed += micros() - startedAt;
+    parsed += count;
+  }
+
+  report(name, elapsed, parsed);
+  Serial.println(F(",,"));
+}
+
+void report(const __FlashStringHelper *name, unsigned long elapsed, uint32_t operations) {
+  Serial.print(name);
+  Serial.print(F(","));
+  Serial.print(elapsed > 0 ? static_cast<uint32_t>(operations * 1000000.0 / elapsed) : 0);
+}
@@ -0,0 +1,75 @@
+#include <NextionInterface.h>
+
+// Measures how long getComponent() takes to resolve a touch event as the number of registered
+// components grows, next to a plain linear scan over the same components for reference.
+
+#if defined(__AVR__)
+constexpr uint16_t MAX_COMPONENTS = 64;
+#else
+constexpr uint16_t MAX_COMPONENTS = 256;
+#endif
+
+constexpr uint8_t PAGE_COUNT = 12;
+constexpr uint16_t LOOKUPS = 2000;
+
+NextionInterface hmi(Serial);
+const NextionComponent *components[MAX_COMPONENTS];
+uint16_t registeredCount = 0;
+volatile uintptr_t sink;
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println(F("components,registry_ns_per_lookup,linear_ns_per_lookup"));
+
+  for (uint16_t size = 16; size <= MAX_COMPONENTS; size *= 2) {
+    registerUpTo(size);
+
+    Serial.print(size);
+    Serial.print(F(","));
+    Serial.print(measureRegistry());
+    Serial.print(F(","));
+    Serial.println(measureLinearScan());
+  }
+}
+
+void loop() {
+}
+
+void registerUpTo(uint16_t size) {
+  for (; registeredCount < size; registeredCount++) {
+    // Spread components over the pages the way a real project would
+    const uint8_t pageId = registeredCount % PAGE_COUNT;
+    const ComponentId id = registeredCount / PAGE_COUNT + 1;
+    components[registeredCount] = new NextionComponent(pageId, id, "c");
+    hmi.registerComponent(*components[registeredCount]);
+  }
+}
+
+unsigned long measureRegistry() {
+  const auto startedAt = micros();
+
+  for (uint16_t i = 0; i < LOOKUPS; i++) {
+    const auto target = components[(i * 7) % registeredCount];
+    sink = reinterpret_cast<uintptr_t>(hmi.getComponent(target->pageId(), target->id()));
+  }
+
+  return (micros() - startedAt) * 1000UL / LOOKUPS;
+}
+
+unsigned long measureLinearScan() {
+  const auto startedAt = micros();
+
+  for (uint16_t i = 0; i < LOOKUPS; i++) {
+    const auto target = components[(i * 7) % registeredCount];
+
+    for (uint16_t j = 0; j < registeredCount; j++) {
+      if (components[j]->pageId() == target->pageId() && components[j]->id() == target->id()) {
+        sink = reinterpret_cast<uintptr_t>(components[j]);
+        break;
+      }
+    }
+  }
+
+  return (micros() - startedAt) * 1000UL / LOOKUPS;
+}
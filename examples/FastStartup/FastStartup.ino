@@ -0,0 +1,51 @@
+#include <NextionInterface.h>
+
+NextionInterface hmi(Serial);
+NextionComponent speed(0, 1, "n0");
+NextionComponent status(0, 2, "t0");
+NextionComponent gauge(0, 3, "z0");
+
+// Large enough for the whole initial state, so that it goes out in one write
+uint8_t batch[256];
+
+void setup() {
+  Serial.begin(9600);
+
+  hmi.enableBatching(batch, sizeof(batch));
+
+  hmi.onInitialState = []() {
+    hmi.changePage(0);
+    hmi.setInteger(speed, 0);
+    hmi.setText(status, "Starting");
+    hmi.setInteger(gauge, 90);
+  };
+
+  hmi.onBaudRateChange = [](uint32_t baudRate) {
+    Serial.flush();
+    Serial.begin(baudRate);
+  };
+
+  // No fixed delay, returns as soon as the display answers
+  NextionStartupOptions options;
+  options.baudRate = 9600;
+  options.maxBaudRate = 115200;
+  options.isTouchCoordinateReported = true;
+
+  const auto report = hmi.begin(options);
+
+  if (!report.isReady) {
+    Serial.println(F("Display not found"));
+    return;
+  }
+
+  Serial.print(F("Ready after "));
+  Serial.print(report.timeToReady);
+  Serial.print(F(" ms, first frame after "));
+  Serial.print(report.timeToFirstFrame);
+  Serial.print(F(" ms at "));
+  Serial.println(report.baudRate);
+}
+
+void loop() {
+  hmi.update();
+}
@@ -0,0 +1,75 @@
+#include <NextionInterface.h>
+#include <new>
+
+// Checks that the interface runs without touching the heap. Build the library with
+// -DNEXTION_DISABLE_HEAP=1 (e.g. build_flags in PlatformIO) so that anything that would allocate
+// fails to compile, then this sketch counts what still reaches operator new at run time. The heap_free
+// test of the CMake host build runs the same check on a desktop.
+
+volatile unsigned long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  return malloc(size);
+}
+
+void *operator new[](size_t size) {
+  allocations++;
+  return malloc(size);
+}
+
+void operator delete(void *pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  free(pointer);
+}
+
+// Room for eight components instead of a registry that grows on the heap
+BasicNextionInterface<NextionConstants::MAX_BUFFER_SIZE, NextionConstants::MAX_FRAME_SIZE, NextionConstants::MAX_PENDING_REQUESTS, 8> hmi(Serial);
+
+// Names are referred to, not copied
+const char speedName[] PROGMEM = "n0";
+const char statusName[] PROGMEM = "t0";
+NextionComponent speed(0, 1, speedName, NextionComponent::NameStorage::Flash);
+NextionComponent status(0, 2, statusName, NextionComponent::NameStorage::Flash);
+NextionComponent gauge(0, 3, "z0", NextionComponent::NameStorage::Ram);
+
+uint8_t batch[64];
+NextionEvent events[4];
+char eventTexts[4 * NextionConstants::MAX_BUFFER_SIZE];
+NextionRateLimit speedLimit;
+NextionShadowEntry statusShadow;
+
+void setup() {
+  Serial.begin(115200);
+
+  hmi.registerComponent(speed);
+  hmi.registerComponent(status);
+  hmi.registerComponent(gauge);
+  hmi.enableBatching(batch, sizeof(batch));
+  hmi.enableEventQueue(events, 4, eventTexts, NextionConstants::MAX_BUFFER_SIZE);
+  hmi.enableRateLimit(speed, speedLimit, 100);
+  hmi.enableShadowCache(status, statusShadow);
+
+  for (int i = 0; i < 100; i++) {
+    hmi.setInteger(speed, i);
+    hmi.setText(status, i % 2 == 0 ? "even" : "odd");
+    hmi.setInteger(gauge, i * 3);
+    hmi.getInteger(speed);
+    hmi.update();
+    hmi.dispatch();
+  }
+
+  hmi.flush();
+
+  Serial.print(F("Allocations: "));
+  Serial.println(allocations);
+  Serial.println(allocations == 0 ? F("PASS") : F("FAIL"));
+}
+
+void loop() {
+  hmi.update();
+  hmi.dispatch();
+}
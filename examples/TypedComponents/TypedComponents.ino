@@ -0,0 +1,36 @@
+#include <NextionInterface.h>
+#include <NextionTypedComponents.h>
+
+NextionInterface hmi(Serial);
+
+// Each type only offers what the display supports for it, speed.setText() would not compile
+NextionNumber speed(0, 1, "n0");
+NextionText status(0, 2, "t0");
+NextionSlider throttle(0, 3, "h0");
+NextionGauge heading(0, 4, "z0");
+NextionProgressBar fuel(0, 5, "j0");
+
+void setup() {
+  Serial.begin(115200);
+
+  hmi.registerComponent(throttle);
+
+  throttle.onNumericDataReceived = [](int32_t value) {
+    heading.setValue(hmi, map(value, 0, 100, 0, 360));
+  };
+
+  throttle.setMinValue(hmi, 0);
+  throttle.setMaxValue(hmi, 100);
+  status.setText(hmi, "Ready");
+  status.setForegroundColor(hmi, NextionConstants::Color::GREEN);
+}
+
+void loop() {
+  hmi.update();
+
+  // "n0.val=" is formatted once, each write only appends the value
+  speed.setValue(hmi, analogRead(A0));
+  fuel.setValue(hmi, analogRead(A1) / 11);
+  throttle.getValue(hmi);
+  delay(100);
+}
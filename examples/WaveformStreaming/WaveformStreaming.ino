@@ -0,0 +1,31 @@
+#include <NextionInterface.h>
+
+NextionInterface hmi(Serial);
+NextionComponent waveform(0, 1, "s0");
+
+// Samples accumulate here while the display takes the previous block
+uint8_t temperatureSamples[128];
+uint8_t pressureSamples[128];
+NextionWaveformChannel temperature(waveform, 0, temperatureSamples, sizeof(temperatureSamples));
+NextionWaveformChannel pressure(waveform, 1, pressureSamples, sizeof(pressureSamples));
+
+unsigned long lastSampleAt = 0;
+
+void setup() {
+  Serial.begin(115200);
+
+  hmi.registerWaveformChannel(temperature);
+  hmi.registerWaveformChannel(pressure);
+}
+
+void loop() {
+  if (millis() - lastSampleAt >= 10) {
+    lastSampleAt = millis();
+
+    // Dropped, and counted, when the display cannot keep up
+    temperature.push(analogRead(A0) >> 2);
+    pressure.push(analogRead(A1) >> 2);
+  }
+
+  hmi.update();  // Streams whatever has accumulated, one channel at a time
+}
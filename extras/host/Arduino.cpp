@@ -0,0 +1,52 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+
+namespace
+{
+    const auto startedAt = std::chrono::steady_clock::now();
+}
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startedAt).count());
+}
+
+unsigned long micros()
+{
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt).count());
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void HardwareSerial::begin(unsigned long baudRate)
+{
+    (void)baudRate;
+}
+
+size_t HardwareSerial::write(uint8_t byte)
+{
+    return putchar(byte) != EOF ? 1 : 0;
+}
+
+// Nothing is ever received
+int HardwareSerial::available()
+{
+    return 0;
+}
+
+int HardwareSerial::read()
+{
+    return -1;
+}
+
+int HardwareSerial::peek()
+{
+    return -1;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// The part of the Arduino core the library and the host sketches use, so that they can be built and
+// run on a desktop. Program memory is plain memory and Serial writes to stdout.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t byte) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+
+        while (size-- > 0)
+        {
+            written += write(*buffer++);
+        }
+
+        return written;
+    }
+
+    size_t print(const char *text)
+    {
+        return write(reinterpret_cast<const uint8_t *>(text), strlen(text));
+    }
+
+    size_t print(const __FlashStringHelper *text)
+    {
+        return print(reinterpret_cast<const char *>(text));
+    }
+
+    size_t print(char character)
+    {
+        return write(static_cast<uint8_t>(character));
+    }
+
+    size_t print(long value)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", value);
+        return print(text);
+    }
+
+    size_t print(unsigned long value)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%lu", value);
+        return print(text);
+    }
+
+    size_t print(int value)
+    {
+        return print(static_cast<long>(value));
+    }
+
+    size_t print(unsigned int value)
+    {
+        return print(static_cast<unsigned long>(value));
+    }
+
+    size_t print(double value)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.2f", value);
+        return print(text);
+    }
+
+    template <typename T>
+    size_t println(T value)
+    {
+        const auto written = print(value);
+        return written + println();
+    }
+
+    size_t println()
+    {
+        return print("\n");
+    }
+
+    virtual void flush()
+    {
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baudRate);
+
+    size_t write(uint8_t byte) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+};
+
+extern HardwareSerial Serial;
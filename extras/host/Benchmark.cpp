@@ -0,0 +1,8 @@
+// The Arduino IDE declares the functions of a sketch before compiling it, this does the same
+#include "Arduino.h"
+
+void benchmarkEncode(const __FlashStringHelper *name, void (*command)(uint16_t));
+void benchmarkParse(const __FlashStringHelper *name, const uint8_t *frame, uint16_t size, void (*request)());
+void report(const __FlashStringHelper *name, unsigned long elapsed, uint32_t operations);
+
+#include "../../examples/Benchmark/Benchmark.ino"
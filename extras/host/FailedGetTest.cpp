@@ -0,0 +1,44 @@
+#include <NextionInterface.h>
+#include <NextionLoopbackStream.h>
+
+// A get that fails on the display is answered with an error code instead of data. The data that follows
+// belongs to the next get and must not be given to the component of the failed one.
+
+namespace
+{
+    const uint8_t REPLIES[] = {
+        0x1A, 0xFF, 0xFF, 0xFF,                         // Invalid variable name or attribute
+        0x71, 0x2A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, // 42
+    };
+
+    const char badName[] PROGMEM = "bad";
+    const char numberName[] PROGMEM = "n1";
+    NextionComponent bad(0, 1, badName, NextionComponent::NameStorage::Flash);
+    NextionComponent number(0, 2, numberName, NextionComponent::NameStorage::Flash);
+
+    const NextionComponent *answered = nullptr;
+    int32_t answer = 0;
+}
+
+int main()
+{
+    NextionLoopbackStream<> stream;
+    NextionInterface hmi(stream);
+    hmi.onNumericDataReceived = [](const NextionComponent *component, int32_t value)
+    {
+        answered = component;
+        answer = value;
+    };
+
+    hmi.getInteger(bad);
+    hmi.getInteger(number);
+    stream.feed(REPLIES, sizeof(REPLIES));
+
+    while (stream.available() > 0)
+    {
+        hmi.update();
+    }
+
+    printf("Answered: %s=%ld\n", answered != nullptr ? answered->name() : "none", static_cast<long>(answer));
+    return answered == &number && answer == 42 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
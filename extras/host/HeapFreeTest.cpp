@@ -0,0 +1,121 @@
+#include <NextionInterface.h>
+#include <NextionLoopbackStream.h>
+#include <new>
+
+// Runs the interface built with NEXTION_DISABLE_HEAP through its usual work and fails when anything
+// reached operator new on the way, construction included.
+
+namespace
+{
+    bool isCounting = false;
+    unsigned long allocations = 0;
+
+    void *allocate(size_t size)
+    {
+        if (isCounting)
+        {
+            allocations++;
+        }
+
+        const auto pointer = malloc(size > 0 ? size : 1);
+
+        if (pointer == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return pointer;
+    }
+
+    const uint8_t REPLIES[] = {
+        0x65, 0x00, 0x01, 0x01, 0xFF, 0xFF, 0xFF,          // Touch on n0
+        0x71, 0x2A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,    // Value of n0
+        0x70, 'r', 'e', 'a', 'd', 'y', 0xFF, 0xFF, 0xFF,   // Text of t0
+        0x66, 0x00, 0xFF, 0xFF, 0xFF,                      // Page 0
+    };
+
+    const char speedName[] PROGMEM = "n0";
+    const char statusName[] PROGMEM = "t0";
+    NextionComponent speed(0, 1, speedName, NextionComponent::NameStorage::Flash);
+    NextionComponent status(0, 2, statusName, NextionComponent::NameStorage::Flash);
+    NextionComponent gauge(0, 3, "z0");
+}
+
+void *operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+int main()
+{
+    isCounting = true;
+
+    {
+        NextionLoopbackStream<> stream;
+        BasicNextionInterface<NextionConstants::MAX_BUFFER_SIZE, NextionConstants::MAX_FRAME_SIZE, NextionConstants::MAX_PENDING_REQUESTS, 8> hmi(stream);
+
+        uint8_t batch[64];
+        NextionEvent events[4];
+        char eventTexts[4 * NextionConstants::MAX_BUFFER_SIZE];
+        NextionRateLimit speedLimit;
+        NextionShadowEntry statusShadow;
+
+        hmi.registerComponent(speed);
+        hmi.registerComponent(status);
+        hmi.registerComponent(gauge);
+        hmi.enableBatching(batch, sizeof(batch));
+        hmi.enableEventQueue(events, 4, eventTexts, NextionConstants::MAX_BUFFER_SIZE);
+        hmi.enableRateLimit(speed, speedLimit, 100);
+        hmi.enableShadowCache(status, statusShadow);
+
+        for (int i = 0; i < 100; i++)
+        {
+            hmi.setInteger(speed, i);
+            hmi.setText(status, i % 2 == 0 ? "even" : "odd");
+            hmi.setInteger(gauge, i * 3);
+            hmi.getInteger(speed);
+            hmi.getText(status);
+            hmi.requestDateTime();
+            hmi.flush();
+
+            stream.feed(REPLIES, sizeof(REPLIES));
+
+            while (stream.available() > 0)
+            {
+                hmi.update();
+            }
+
+            hmi.dispatch();
+            stream.clearWritten();
+        }
+    }
+
+    isCounting = false;
+    printf("Allocations: %lu\n", allocations);
+    return allocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,49 @@
+#include <NextionInterface.h>
+#include <NextionLoopbackStream.h>
+
+// With the receive queue, receive() only frames what arrives, e.g. from an interrupt: it must neither
+// write to the display nor call back. The frames are decoded by the next update().
+
+namespace
+{
+    const uint8_t REPLIES[] = {
+        0x88, 0xFF, 0xFF, 0xFF,                         // Ready
+        0x71, 0x2A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, // 42
+        0x65, 0x00, 0x02, 0x01, 0xFF, 0xFF, 0xFF,       // Touch on n1
+    };
+
+    const char numberName[] PROGMEM = "n1";
+    NextionComponent number(0, 2, numberName, NextionComponent::NameStorage::Flash);
+
+    int32_t answer = 0;
+    int touches = 0;
+}
+
+int main()
+{
+    NextionLoopbackStream<> stream;
+    NextionInterface hmi(stream);
+    uint8_t frames[4 * (NextionConstants::MAX_BUFFER_SIZE + 2)];
+    hmi.registerComponent(number);
+    hmi.onNumericDataReceived = [](const NextionComponent *, int32_t value)
+    {
+        answer = value;
+    };
+    hmi.onTouchEvent = [](uint8_t, ComponentId, NextionConstants::ClickEvent)
+    {
+        touches++;
+    };
+
+    hmi.enableReceiveQueue(frames, sizeof(frames));
+    hmi.getInteger(number);
+    stream.clearWritten();
+    stream.feed(REPLIES, sizeof(REPLIES));
+
+    const auto received = hmi.receive();
+    const auto isQuiet = stream.bytesWritten() == 0 && answer == 0 && touches == 0;
+    hmi.update();
+
+    printf("Received: %u, quiet: %d, answer: %ld, touches: %d, dropped: %lu\n", received, isQuiet,
+           static_cast<long>(answer), touches, static_cast<unsigned long>(hmi.droppedReceivedFrameCount()));
+    return received == 3 && isQuiet && answer == 42 && touches == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
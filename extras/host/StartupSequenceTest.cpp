@@ -0,0 +1,47 @@
+#include <NextionInterface.h>
+#include <NextionLoopbackStream.h>
+
+// A display coming out of reset sends 00 00 00 FF FF FF and then NextionReady (88 FF FF FF). The first
+// frame is too long for an error code, which must not make the parser drop the ready frame after it.
+// Once ready, the settings and the initial state go out in one write when the transmit buffer holds them.
+
+namespace
+{
+    const uint8_t STARTUP_SEQUENCE[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x88, 0xFF, 0xFF, 0xFF};
+
+    NextionComponent title(0, 1, "t0");
+    NextionComponent status(0, 2, "t1");
+    NextionComponent speed(0, 3, "n0");
+
+    NextionLoopbackStream<> stream;
+    BasicNextionInterface<NextionConstants::MAX_BUFFER_SIZE, 160> hmi(stream);
+    uint32_t writesBeforeInitialState = 0;
+    uint32_t bytesBeforeInitialState = 0;
+}
+
+int main()
+{
+    stream.feed(STARTUP_SEQUENCE, sizeof(STARTUP_SEQUENCE));
+    hmi.onInitialState = []()
+    {
+        writesBeforeInitialState = stream.writeCalls();
+        bytesBeforeInitialState = stream.bytesWritten();
+        hmi.setText(title, "A title longer than the default transmit buffer holds");
+        hmi.setText(status, "Starting up");
+        hmi.setInteger(speed, 0);
+    };
+
+    NextionStartupOptions options;
+    options.readyTimeout = 500;
+    const auto report = hmi.begin(options);
+
+    const auto writes = stream.writeCalls() - writesBeforeInitialState;
+    const auto bytes = stream.bytesWritten() - bytesBeforeInitialState;
+    const auto expectedBytes = strlen("bkcmd=1\xFF\xFF\xFF" "sendxy=0\xFF\xFF\xFF" "thup=1\xFF\xFF\xFF" "sendme\xFF\xFF\xFF") +
+                               strlen("t0.txt=\"A title longer than the default transmit buffer holds\"\xFF\xFF\xFF") +
+                               strlen("t1.txt=\"Starting up\"\xFF\xFF\xFF" "n0.val=0\xFF\xFF\xFF");
+
+    printf("Ready: %s, writes: %lu, bytes: %lu of %lu\n", report.isReady ? "yes" : "no", static_cast<unsigned long>(writes),
+           static_cast<unsigned long>(bytes), static_cast<unsigned long>(expectedBytes));
+    return report.isReady && writes == 1 && bytes == expectedBytes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,59 @@
+#include <NextionLoopbackStream.h>
+#include <NextionTypedComponents.h>
+#include <utility>
+
+// Built without the heap: typed components named by a string literal need none, and writing or reading
+// an attribute their type does not have must not compile, even through the generic setters.
+
+namespace
+{
+    template <typename Component, typename = void>
+    struct CanSetText
+    {
+        static constexpr bool value = false;
+    };
+
+    template <typename Component>
+    struct CanSetText<Component, decltype(std::declval<NextionInterfaceBase &>().setText(std::declval<const Component &>(), ""), void())>
+    {
+        static constexpr bool value = true;
+    };
+
+    template <typename Component, typename = void>
+    struct CanSetInteger
+    {
+        static constexpr bool value = false;
+    };
+
+    template <typename Component>
+    struct CanSetInteger<Component, decltype(std::declval<NextionInterfaceBase &>().setInteger(std::declval<const Component &>(), 0), void())>
+    {
+        static constexpr bool value = true;
+    };
+
+    static_assert(!CanSetText<NextionNumber>::value, "A number has no text");
+    static_assert(!CanSetText<NextionSlider>::value, "A slider has no text");
+    static_assert(!CanSetInteger<NextionText>::value, "A text has no value");
+    static_assert(CanSetText<NextionText>::value, "A text has a text");
+    static_assert(CanSetInteger<NextionNumber>::value, "A number has a value");
+    static_assert(CanSetText<NextionComponent>::value && CanSetInteger<NextionComponent>::value, "Untyped components take either");
+
+    NextionNumber speed(0, 1, "n0");
+    NextionText status(0, 2, "t0");
+}
+
+int main()
+{
+    NextionLoopbackStream<> stream;
+    BasicNextionInterface<NextionConstants::MAX_BUFFER_SIZE, NextionConstants::MAX_FRAME_SIZE, NextionConstants::MAX_PENDING_REQUESTS, 2> hmi(stream);
+    hmi.registerComponent(speed);
+    hmi.registerComponent(status);
+
+    speed.setValue(hmi, 42);
+    status.setText(hmi, "ok");
+
+    static const char EXPECTED[] = "n0.val=42\xFF\xFF\xFFt0.txt=\"ok\"\xFF\xFF\xFF";
+    const auto isWritten = stream.writtenSize() == sizeof(EXPECTED) - 1 && memcmp(stream.written(), EXPECTED, sizeof(EXPECTED) - 1) == 0;
+    printf("Written: %.*s\n", static_cast<int>(stream.writtenSize()), reinterpret_cast<const char *>(stream.written()));
+    return isWritten ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,13 @@
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+// Sketches run their setup() and a single loop()
+int main()
+{
+    setup();
+    loop();
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionConfig.h"
+#include "NextionConstants.h"
+
+using ComponentId = uint8_t;
+
+class NextionComponent
+{
+public:
+    enum class NameStorage : uint8_t
+    {
+        Ram,
+        Flash
+    };
+
+    // Refers to a name that outlives the component, either a string literal in RAM or a PROGMEM string.
+    // Nothing is allocated, and static instances are constant-initialised. Names built at run time need a
+    // NextionOwnedComponent, which keeps its own copy.
+    constexpr NextionComponent(uint8_t pageId, ComponentId id, const char *name, NameStorage storage = NameStorage::Ram)
+        : m_pageId(pageId), m_id(id), m_name(name), m_isNameInFlash(storage == NameStorage::Flash)
+    {
+    }
+
+    // F() is only allowed inside a function, components at namespace scope name a PROGMEM array instead
+    NextionComponent(uint8_t pageId, ComponentId id, const __FlashStringHelper *name)
+        : NextionComponent(pageId, id, reinterpret_cast<const char *>(name), NameStorage::Flash)
+    {
+    }
+
+    [[nodiscard]] uint8_t pageId() const
+    {
+        return m_pageId;
+    }
+
+    [[nodiscard]] ComponentId id() const
+    {
+        return m_id;
+    }
+
+    // Points into program memory when isNameInFlash() is true.
+    [[nodiscard]] const char *name() const
+    {
+        return m_name;
+    }
+
+    [[nodiscard]] bool isNameInFlash() const
+    {
+        return m_isNameInFlash;
+    }
+
+    void (*onTouchEvent)(NextionConstants::ClickEvent event) = nullptr;
+    void (*onNumericDataReceived)(int32_t data) = nullptr;
+    void (*onStringDataReceived)(char *data) = nullptr;
+
+private:
+    uint8_t m_pageId;
+    ComponentId m_id;
+    const char *m_name;
+    bool m_isNameInFlash;
+};
+
+#if !NEXTION_DISABLE_HEAP
+// Keeps its own copy of the name, so it may be built from a temporary buffer.
+class NextionOwnedComponent : public NextionComponent
+{
+public:
+    NextionOwnedComponent(uint8_t pageId, ComponentId id, const char *name)
+        : NextionComponent(pageId, id, copyName(name))
+    {
+    }
+
+    NextionOwnedComponent(const NextionOwnedComponent &) = delete;
+    NextionOwnedComponent &operator=(const NextionOwnedComponent &) = delete;
+
+    ~NextionOwnedComponent()
+    {
+        delete[] name();
+    }
+
+private:
+    static const char *copyName(const char *name)
+    {
+        const auto copy = new char[strlen(name) + 1];
+        strcpy(copy, name);
+        return copy;
+    }
+};
+#endif
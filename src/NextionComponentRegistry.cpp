@@ -0,0 +1,153 @@
+#include "NextionComponentRegistry.h"
+
+#define INITIAL_CAPACITY 8
+
+NextionComponentRegistry::NextionComponentRegistry()
+    : m_components(nullptr),
+      m_size(0),
+      m_capacity(0),
+      m_isStorageOwned(false)
+{
+}
+
+NextionComponentRegistry::~NextionComponentRegistry()
+{
+#if !NEXTION_DISABLE_HEAP
+    if (m_isStorageOwned)
+    {
+        delete[] m_components;
+    }
+#endif
+}
+
+void NextionComponentRegistry::setStorage(const NextionComponent **storage, size_t capacity)
+{
+    const auto size = m_size < capacity ? m_size : capacity;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        storage[i] = m_components[i];
+    }
+
+#if !NEXTION_DISABLE_HEAP
+    if (m_isStorageOwned)
+    {
+        delete[] m_components;
+    }
+#endif
+
+    m_components = storage;
+    m_size = size;
+    m_capacity = capacity;
+    m_isStorageOwned = false;
+}
+
+bool NextionComponentRegistry::add(const NextionComponent &component)
+{
+    const auto key = keyOf(component.pageId(), component.id());
+    const auto index = lowerBound(key);
+
+    if (index < m_size && keyOf(m_components[index]->pageId(), m_components[index]->id()) == key)
+    {
+        // The first component registered for a given page and id wins
+        return false;
+    }
+
+    if (m_size >= m_capacity && !grow())
+    {
+        return false;
+    }
+
+    for (auto i = m_size; i > index; i--)
+    {
+        m_components[i] = m_components[i - 1];
+    }
+
+    m_components[index] = &component;
+    m_size++;
+    return true;
+}
+
+const NextionComponent *NextionComponentRegistry::find(uint8_t pageId, ComponentId id) const
+{
+    const auto index = lowerBound(keyOf(pageId, id));
+
+    if (index >= m_size)
+    {
+        return nullptr;
+    }
+
+    const auto component = m_components[index];
+    return component->pageId() == pageId && component->id() == id ? component : nullptr;
+}
+
+size_t NextionComponentRegistry::size() const
+{
+    return m_size;
+}
+
+const NextionComponent *NextionComponentRegistry::at(size_t index) const
+{
+    return index < m_size ? m_components[index] : nullptr;
+}
+
+// Private methods
+
+size_t NextionComponentRegistry::lowerBound(uint16_t key) const
+{
+    size_t low = 0;
+    size_t high = m_size;
+
+    while (low < high)
+    {
+        const auto middle = low + (high - low) / 2;
+
+        if (keyOf(m_components[middle]->pageId(), m_components[middle]->id()) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+bool NextionComponentRegistry::grow()
+{
+#if NEXTION_DISABLE_HEAP
+    return false;
+#else
+    if (m_components != nullptr && !m_isStorageOwned)
+    {
+        // Given storage is full
+        return false;
+    }
+
+    const auto capacity = m_capacity == 0 ? INITIAL_CAPACITY : m_capacity * 2;
+    const auto components = new const NextionComponent *[capacity];
+
+    if (components == nullptr)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_size; i++)
+    {
+        components[i] = m_components[i];
+    }
+
+    delete[] m_components;
+    m_components = components;
+    m_capacity = capacity;
+    m_isStorageOwned = true;
+    return true;
+#endif
+}
+
+uint16_t NextionComponentRegistry::keyOf(uint8_t pageId, ComponentId id)
+{
+    return static_cast<uint16_t>(pageId) << 8 | id;
+}
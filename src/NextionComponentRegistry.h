@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionComponent.h"
+
+// Keeps registered components sorted by (page, id) so that incoming touch events can be resolved
+// with a binary search instead of walking every component. Grows on the heap unless it is given storage.
+class NextionComponentRegistry
+{
+public:
+    NextionComponentRegistry();
+    ~NextionComponentRegistry();
+
+    NextionComponentRegistry(const NextionComponentRegistry &) = delete;
+    NextionComponentRegistry &operator=(const NextionComponentRegistry &) = delete;
+
+    // Entries added so far are kept when they fit, the storage must outlive the registry
+    void setStorage(const NextionComponent **storage, size_t capacity);
+
+    bool add(const NextionComponent &component);
+    [[nodiscard]] const NextionComponent *find(uint8_t pageId, ComponentId id) const;
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] const NextionComponent *at(size_t index) const;
+
+private:
+    const NextionComponent **m_components;
+    size_t m_size;
+    size_t m_capacity;
+    bool m_isStorageOwned;
+
+    [[nodiscard]] size_t lowerBound(uint16_t key) const;
+    [[nodiscard]] bool grow();
+
+    [[nodiscard]] static uint16_t keyOf(uint8_t pageId, ComponentId id);
+};
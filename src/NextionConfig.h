@@ -0,0 +1,15 @@
+#pragma once
+
+// Build options. The library is compiled separately from the sketch, so these must be set for the whole
+// build (e.g. build_flags = -DNEXTION_ENABLE_METRICS=1), not with a #define in the sketch.
+
+// Collects NextionMetrics, see NextionInterfaceBase::metrics(). Nothing is compiled in when disabled.
+#ifndef NEXTION_ENABLE_METRICS
+#define NEXTION_ENABLE_METRICS 0
+#endif
+
+// Nothing is allocated on the heap. Components must then be given a name that outlives them (see
+// NextionComponent::NameStorage) and the interface room for them (MaxComponents of BasicNextionInterface).
+#ifndef NEXTION_DISABLE_HEAP
+#define NEXTION_DISABLE_HEAP 0
+#endif
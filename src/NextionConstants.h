@@ -1,3 +1,5 @@
+#pragma once
+
 #include "Arduino.h"
 
 namespace NextionConstants
@@ -7,14 +9,17 @@ namespace NextionConstants
     constexpr auto COMMAND_SEPARATOR = ' ';
     constexpr auto ASSIGNMENT_CHARACTER = '=';
     constexpr auto PARAMETER_SEPARATOR = ',';
-    constexpr auto NUMERIC_ATTRIBUTE = ".val";
-    constexpr auto TEXT_ATTRIBUTE = ".txt";
-    constexpr auto BACKGROUND_ATTRIBUTE = ".bco";
-    constexpr auto BACKGROUND_2_ATTRIBUTE = ".bco2";
-    constexpr auto FOREGROUND_ATTRIBUTE = ".pco";
-    constexpr auto FOREGROUND_2_ATTRIBUTE = ".pco2";
     constexpr auto MAX_BUFFER_SIZE = 32;
+    constexpr auto MAX_FRAME_SIZE = 64;
+    constexpr auto MAX_PENDING_REQUESTS = 8;
     constexpr auto MAX_COMPONENT_NAME_LENGTH = 10;
+    constexpr uint32_t SUPPORTED_BAUD_RATES[] = {2400, 4800, 9600, 19200, 31250, 38400, 57600, 115200,
+                                                 230400, 250000, 256000, 512000, 921600};
+    constexpr auto SUPPORTED_BAUD_RATE_COUNT = sizeof(SUPPORTED_BAUD_RATES) / sizeof(SUPPORTED_BAUD_RATES[0]);
+    constexpr uint32_t MAX_BAUD_RATE = 921600;
+    constexpr uint16_t MAX_TRANSPARENT_DATA_SIZE = 1024;
+    constexpr uint16_t SERIAL_BUFFER_SIZE = 1024;
+    constexpr uint32_t DEFAULT_DRAIN_RATE = 4000;
 
     enum class Command : uint16_t
     {
@@ -28,6 +33,15 @@ namespace NextionConstants
         SetVisibility,
         EnableTouchEvent,
         Sleep,
+        SetReturnLevel,
+        BaudRate,
+        DefaultBaudRate,
+        AddTransparentData,
+        StopRefresh,
+        StartRefresh,
+        Brightness,
+        SendTouchCoordinates,
+        WakeOnTouch,
         RtcYear,
         RtcMonth,
         RtcDay,
@@ -37,6 +51,31 @@ namespace NextionConstants
         RtcDayOfTheWeek
     };
 
+    constexpr auto COMMAND_COUNT = static_cast<uint16_t>(Command::RtcDayOfTheWeek) + 1;
+
+    // Which results the display reports after each command (bkcmd)
+    enum class ReturnLevel : uint8_t
+    {
+        None,
+        OnSuccess,
+        OnFailure,
+        Always
+    };
+
+    enum class Attribute : uint8_t
+    {
+        Value,
+        Text,
+        Background,
+        Background2,
+        Foreground,
+        Foreground2,
+        MinValue,
+        MaxValue
+    };
+
+    constexpr auto ATTRIBUTE_COUNT = 8;
+
     enum class ClickEvent : uint8_t
     {
         Released,
@@ -109,6 +148,7 @@ namespace NextionConstants
         constexpr auto TOUCH_EVENT = 4;
         constexpr auto CURRENT_PAGE_NUMBER = 2;
         constexpr auto NUMERIC_DATA_ENCLOSED = 5;
+        constexpr auto TOUCH_COORDINATE = 6;
     }
 
     enum class DayOfTheWeek
@@ -158,6 +198,9 @@ namespace NextionConstants
         }
         case ReturnCode::TouchCoordinateAwake:
         case ReturnCode::TouchCoordinateSleep:
+        {
+            return 6 + TERMINATION_BYTES_SIZE;
+        }
         case ReturnCode::StringDataEnclosed:
         {
             return TERMINATION_BYTES_SIZE;
@@ -181,4 +224,88 @@ namespace NextionConstants
         }
         }
     }
+
+    // Strings sent to the display are kept in program memory, one fixed size row per enum value. A new
+    // command only needs its enum value and a row here, the checks below catch a missing or misplaced
+    // row.
+    struct CommandName
+    {
+        Command command;
+        char name[9];
+    };
+
+    constexpr CommandName COMMAND_NAMES[] PROGMEM = {
+        {Command::Reset, "rest"},
+        {Command::Get, "get"},
+        {Command::ChangePage, "page"},
+        {Command::Refresh, "ref"},
+        {Command::Click, "click"},
+        {Command::GetPageId, "sendme"},
+        {Command::Convert, "covx"},
+        {Command::SetVisibility, "vis"},
+        {Command::EnableTouchEvent, "tsw"},
+        {Command::Sleep, "sleep"},
+        {Command::SetReturnLevel, "bkcmd"},
+        {Command::BaudRate, "baud"},
+        {Command::DefaultBaudRate, "bauds"},
+        {Command::AddTransparentData, "addt"},
+        {Command::StopRefresh, "ref_stop"},
+        {Command::StartRefresh, "ref_star"},
+        {Command::Brightness, "dim"},
+        {Command::SendTouchCoordinates, "sendxy"},
+        {Command::WakeOnTouch, "thup"},
+        {Command::RtcYear, "rtc0"},
+        {Command::RtcMonth, "rtc1"},
+        {Command::RtcDay, "rtc2"},
+        {Command::RtcHour, "rtc3"},
+        {Command::RtcMinute, "rtc4"},
+        {Command::RtcSecond, "rtc5"},
+        {Command::RtcDayOfTheWeek, "rtc6"}};
+
+    struct AttributeSuffix
+    {
+        Attribute attribute;
+        char suffix[8];
+    };
+
+    constexpr AttributeSuffix ATTRIBUTE_SUFFIXES[] PROGMEM = {
+        {Attribute::Value, ".val"},
+        {Attribute::Text, ".txt"},
+        {Attribute::Background, ".bco"},
+        {Attribute::Background2, ".bco2"},
+        {Attribute::Foreground, ".pco"},
+        {Attribute::Foreground2, ".pco2"},
+        {Attribute::MinValue, ".minval"},
+        {Attribute::MaxValue, ".maxval"}};
+
+    struct DayName
+    {
+        DayOfTheWeek day;
+        char name[10];
+    };
+
+    constexpr DayName DAY_NAMES[] PROGMEM = {
+        {DayOfTheWeek::Sunday, "Sunday"},
+        {DayOfTheWeek::Monday, "Monday"},
+        {DayOfTheWeek::Tuesday, "Tuesday"},
+        {DayOfTheWeek::Wednesday, "Wednesday"},
+        {DayOfTheWeek::Thursday, "Thursday"},
+        {DayOfTheWeek::Friday, "Friday"},
+        {DayOfTheWeek::Saturday, "Saturday"}};
+
+    constexpr auto DAY_COUNT = 7;
+
+    // True when every row sits at the index of its own enum value
+    template <typename TRow, typename TKey, size_t N>
+    constexpr bool isIndexedBy(const TRow (&table)[N], TKey TRow::*key, size_t index = 0)
+    {
+        return index >= N || (static_cast<size_t>(table[index].*key) == index && isIndexedBy(table, key, index + 1));
+    }
+
+    static_assert(sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]) == COMMAND_COUNT, "Every command needs a row in COMMAND_NAMES");
+    static_assert(isIndexedBy(COMMAND_NAMES, &CommandName::command), "COMMAND_NAMES must follow the order of Command");
+    static_assert(sizeof(ATTRIBUTE_SUFFIXES) / sizeof(ATTRIBUTE_SUFFIXES[0]) == ATTRIBUTE_COUNT, "Every attribute needs a row in ATTRIBUTE_SUFFIXES");
+    static_assert(isIndexedBy(ATTRIBUTE_SUFFIXES, &AttributeSuffix::attribute), "ATTRIBUTE_SUFFIXES must follow the order of Attribute");
+    static_assert(sizeof(DAY_NAMES) / sizeof(DAY_NAMES[0]) == DAY_COUNT, "Every day needs a row in DAY_NAMES");
+    static_assert(isIndexedBy(DAY_NAMES, &DayName::day), "DAY_NAMES must follow the order of DayOfTheWeek");
 }
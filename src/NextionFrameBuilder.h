@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionConstants.h"
+
+// Builds a complete command frame in caller-provided storage so that it can be
+// handed to the stream in a single write. Appending past the capacity marks the
+// frame as invalid instead of truncating it silently.
+class NextionFrameBuilder
+{
+public:
+    // Lets the owner of the storage make room once the frame outgrows it, e.g. by writing out what is
+    // in front of it. Moves the size bytes of the frame and returns where they start now.
+    using RoomMaker = uint8_t *(*)(void *owner, const uint8_t *frame, size_t size);
+
+    NextionFrameBuilder(uint8_t *buffer, size_t capacity, RoomMaker roomMaker = nullptr, void *owner = nullptr)
+        : m_buffer(buffer), m_capacity(capacity), m_size(0), m_isValid(true), m_expectedReply(NextionConstants::ReturnCode::InstructionSuccessful),
+          m_roomMaker(roomMaker), m_owner(owner)
+    {
+    }
+
+    void append(char character)
+    {
+        if (m_size >= m_capacity && !makeRoom())
+        {
+            m_isValid = false;
+            return;
+        }
+
+        m_buffer[m_size++] = static_cast<uint8_t>(character);
+    }
+
+    void append(const char *text)
+    {
+        while (*text != '\0')
+        {
+            append(*text++);
+        }
+    }
+
+    void append(const char *text, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            append(text[i]);
+        }
+    }
+
+    // Appends a string stored in program memory
+    void appendFlash(const char *text)
+    {
+        for (auto character = static_cast<char>(pgm_read_byte(text)); character != '\0'; character = static_cast<char>(pgm_read_byte(++text)))
+        {
+            append(character);
+        }
+    }
+
+    void appendInteger(int32_t value)
+    {
+        if (value < 0)
+        {
+            append('-');
+            appendUnsigned(0u - static_cast<uint32_t>(value));
+            return;
+        }
+
+        appendUnsigned(static_cast<uint32_t>(value));
+    }
+
+    void appendUnsigned(uint32_t value)
+    {
+        char digits[10];
+        uint8_t count = 0;
+
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+
+        while (count > 0)
+        {
+            append(digits[--count]);
+        }
+    }
+
+    void terminate()
+    {
+        for (size_t i = 0; i < NextionConstants::TERMINATION_BYTES_SIZE; i++)
+        {
+            append(static_cast<char>(NextionConstants::TERMINATION_BYTES[i]));
+        }
+    }
+
+    [[nodiscard]] const uint8_t *data() const
+    {
+        return m_buffer;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return m_size;
+    }
+
+    [[nodiscard]] bool isValid() const
+    {
+        return m_isValid;
+    }
+
+    // True when length more bytes still leave room for the termination bytes
+    [[nodiscard]] bool fits(size_t length) const
+    {
+        return m_isValid && m_capacity - m_size >= length + NextionConstants::TERMINATION_BYTES_SIZE;
+    }
+
+    // Done at most once, false when no room was made
+    bool makeRoom()
+    {
+        if (m_roomMaker == nullptr)
+        {
+            return false;
+        }
+
+        const auto start = m_roomMaker(m_owner, m_buffer, m_size);
+        m_roomMaker = nullptr;
+
+        if (start == nullptr || start >= m_buffer)
+        {
+            return false;
+        }
+
+        m_capacity += static_cast<size_t>(m_buffer - start);
+        m_buffer = start;
+        return true;
+    }
+
+    // Set for frames the display answers with data (e.g. get) instead of a result code
+    void expectReply(NextionConstants::ReturnCode reply)
+    {
+        m_expectedReply = reply;
+    }
+
+    [[nodiscard]] NextionConstants::ReturnCode expectedReply() const
+    {
+        return m_expectedReply;
+    }
+
+private:
+    uint8_t *m_buffer;
+    size_t m_capacity;
+    size_t m_size;
+    bool m_isValid;
+    NextionConstants::ReturnCode m_expectedReply;
+    RoomMaker m_roomMaker;
+    void *m_owner;
+};
@@ -0,0 +1,217 @@
+#include "NextionFrameQueue.h"
+
+#define HEADER_SIZE 4
+#define LENGTH_OFFSET 0
+#define KEY_LENGTH_OFFSET 2
+#define TAG_OFFSET 3
+
+NextionFrameQueue::NextionFrameQueue()
+    : m_buffer(nullptr),
+      m_capacity(0),
+      m_size(0)
+{
+}
+
+void NextionFrameQueue::setStorage(uint8_t *buffer, size_t capacity)
+{
+    m_buffer = buffer;
+    m_capacity = buffer != nullptr ? capacity : 0;
+    m_size = 0;
+}
+
+bool NextionFrameQueue::hasStorage() const
+{
+    return m_buffer != nullptr;
+}
+
+bool NextionFrameQueue::push(const uint8_t *frame, uint16_t length, uint8_t keyLength, uint8_t tag)
+{
+    if (keyLength > 0)
+    {
+        auto replaceable = m_size;
+
+        for (size_t offset = 0; offset < m_size; offset += HEADER_SIZE + lengthAt(offset))
+        {
+            if (m_buffer[offset + KEY_LENGTH_OFFSET] == 0)
+            {
+                replaceable = m_size;
+            }
+            else if (isSameRecord(offset, frame, keyLength, tag))
+            {
+                replaceable = offset;
+            }
+        }
+
+        if (replaceable < m_size)
+        {
+            erase(replaceable);
+        }
+    }
+
+    return append(frame, length, keyLength, tag);
+}
+
+bool NextionFrameQueue::append(const uint8_t *frame, uint16_t length, uint8_t keyLength, uint8_t tag)
+{
+    if (m_capacity - m_size < static_cast<size_t>(HEADER_SIZE + length))
+    {
+        return false;
+    }
+
+    m_buffer[m_size + LENGTH_OFFSET] = static_cast<uint8_t>(length);
+    m_buffer[m_size + LENGTH_OFFSET + 1] = static_cast<uint8_t>(length >> 8);
+    m_buffer[m_size + KEY_LENGTH_OFFSET] = keyLength;
+    m_buffer[m_size + TAG_OFFSET] = tag;
+    memcpy(&m_buffer[m_size + HEADER_SIZE], frame, length);
+    m_size += HEADER_SIZE + length;
+    return true;
+}
+
+void NextionFrameQueue::popFront()
+{
+    if (m_size > 0)
+    {
+        erase(0);
+    }
+}
+
+void NextionFrameQueue::popFront(size_t offset)
+{
+    if (offset >= m_size)
+    {
+        m_size = 0;
+        return;
+    }
+
+    memmove(m_buffer, &m_buffer[offset], m_size - offset);
+    m_size -= offset;
+}
+
+void NextionFrameQueue::remove(uint8_t tag)
+{
+    size_t kept = 0;
+
+    for (size_t offset = 0; offset < m_size;)
+    {
+        const auto recordSize = HEADER_SIZE + lengthAt(offset);
+
+        if (m_buffer[offset + TAG_OFFSET] != tag)
+        {
+            memmove(&m_buffer[kept], &m_buffer[offset], recordSize);
+            kept += recordSize;
+        }
+
+        offset += recordSize;
+    }
+
+    m_size = kept;
+}
+
+void NextionFrameQueue::retag(const uint8_t *frame, uint8_t keyLength, uint8_t tag)
+{
+    if (keyLength == 0)
+    {
+        return;
+    }
+
+    for (size_t offset = 0; offset < m_size; offset += HEADER_SIZE + lengthAt(offset))
+    {
+        if (isSameKey(offset, frame, keyLength))
+        {
+            m_buffer[offset + TAG_OFFSET] = tag;
+        }
+    }
+}
+
+void NextionFrameQueue::clear()
+{
+    m_size = 0;
+}
+
+bool NextionFrameQueue::isEmpty() const
+{
+    return m_size == 0;
+}
+
+bool NextionFrameQueue::next(size_t &offset, Record &record) const
+{
+    if (offset >= m_size)
+    {
+        return false;
+    }
+
+    record.frame = &m_buffer[offset + HEADER_SIZE];
+    record.length = lengthAt(offset);
+    record.keyLength = m_buffer[offset + KEY_LENGTH_OFFSET];
+    record.tag = m_buffer[offset + TAG_OFFSET];
+    offset += HEADER_SIZE + record.length;
+    return true;
+}
+
+bool NextionFrameQueue::containsKey(size_t offset, const uint8_t *frame, uint8_t keyLength) const
+{
+    if (keyLength == 0)
+    {
+        return false;
+    }
+
+    for (; offset < m_size; offset += HEADER_SIZE + lengthAt(offset))
+    {
+        if (isSameKey(offset, frame, keyLength))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t NextionFrameQueue::pack()
+{
+    return pack(m_size);
+}
+
+size_t NextionFrameQueue::pack(size_t offset)
+{
+    size_t packedSize = 0;
+
+    for (size_t recordOffset = 0; recordOffset < offset && recordOffset < m_size;)
+    {
+        const auto length = lengthAt(recordOffset);
+        memmove(&m_buffer[packedSize], &m_buffer[recordOffset + HEADER_SIZE], length);
+        packedSize += length;
+        recordOffset += HEADER_SIZE + length;
+    }
+
+    return packedSize;
+}
+
+const uint8_t *NextionFrameQueue::data() const
+{
+    return m_buffer;
+}
+
+// Private methods
+
+bool NextionFrameQueue::isSameKey(size_t offset, const uint8_t *frame, uint8_t keyLength) const
+{
+    return m_buffer[offset + KEY_LENGTH_OFFSET] == keyLength &&
+           memcmp(&m_buffer[offset + HEADER_SIZE], frame, keyLength) == 0;
+}
+
+bool NextionFrameQueue::isSameRecord(size_t offset, const uint8_t *frame, uint8_t keyLength, uint8_t tag) const
+{
+    return m_buffer[offset + TAG_OFFSET] == tag && isSameKey(offset, frame, keyLength);
+}
+
+void NextionFrameQueue::erase(size_t offset)
+{
+    const auto recordSize = HEADER_SIZE + lengthAt(offset);
+    memmove(&m_buffer[offset], &m_buffer[offset + recordSize], m_size - offset - recordSize);
+    m_size -= recordSize;
+}
+
+uint16_t NextionFrameQueue::lengthAt(size_t offset) const
+{
+    return static_cast<uint16_t>(m_buffer[offset + LENGTH_OFFSET] | m_buffer[offset + LENGTH_OFFSET + 1] << 8);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Queues complete frames in caller-provided storage so that they can be sent in one write.
+//
+// Each frame is stored behind a small header holding its length, the length of its coalescing key and a
+// tag. Frames with a key (e.g. "n0.val=") replace an earlier queued frame with the same key and tag, unless
+// a frame without a key was queued in between, as that one may depend on the earlier value.
+class NextionFrameQueue
+{
+public:
+    struct Record
+    {
+        const uint8_t *frame;
+        uint16_t length;
+        uint8_t keyLength;
+        uint8_t tag;
+    };
+
+    NextionFrameQueue();
+
+    void setStorage(uint8_t *buffer, size_t capacity);
+    [[nodiscard]] bool hasStorage() const;
+
+    bool push(const uint8_t *frame, uint16_t length, uint8_t keyLength, uint8_t tag = 0);
+
+    // Same as push() but never replaces a queued frame
+    bool append(const uint8_t *frame, uint16_t length, uint8_t keyLength, uint8_t tag = 0);
+
+    void popFront();
+
+    // Drops every frame before offset
+    void popFront(size_t offset);
+
+    // Drops every frame with this tag
+    void remove(uint8_t tag);
+
+    // Gives every frame with the same key this tag
+    void retag(const uint8_t *frame, uint8_t keyLength, uint8_t tag);
+    void clear();
+
+    [[nodiscard]] bool isEmpty() const;
+
+    // Reads the frame at offset and moves offset to the next one, starting from 0. Returns false past the
+    // last frame.
+    bool next(size_t &offset, Record &record) const;
+
+    // Whether a frame with the same key is queued at or after offset
+    [[nodiscard]] bool containsKey(size_t offset, const uint8_t *frame, uint8_t keyLength) const;
+
+    // Strips the headers in place and returns the number of bytes left at data(). The queue must be cleared
+    // before it is used again.
+    [[nodiscard]] size_t pack();
+
+    // Same for the frames before offset only, those after it are left as they are. The packed frames must
+    // then be dropped with popFront(offset).
+    [[nodiscard]] size_t pack(size_t offset);
+    [[nodiscard]] const uint8_t *data() const;
+
+private:
+    uint8_t *m_buffer;
+    size_t m_capacity;
+    size_t m_size;
+
+    [[nodiscard]] bool isSameKey(size_t offset, const uint8_t *frame, uint8_t keyLength) const;
+    [[nodiscard]] bool isSameRecord(size_t offset, const uint8_t *frame, uint8_t keyLength, uint8_t tag) const;
+    void erase(size_t offset);
+    [[nodiscard]] uint16_t lengthAt(size_t offset) const;
+};
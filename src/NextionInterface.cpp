@@ -1,710 +1,2973 @@
 #include "NextionInterface.h"
+#include "NextionUtils.h"
 
-#define digits(n) ((n) == 0 ? 1 : ((n) < 0 ? 2 : 1) + static_cast<int>(std::log10(std::abs(n))))
 #define TIMEOUT 100
-
-DateTime dateTime;
-
-NextionInterface::NextionInterface(Stream &stream)
+#define BAUD_RATE_SETTLE_TIME 20
+#define FLOW_RECOVERY_TIME 1000
+#define MAX_FLOW_BACKOFF 3
+#define SUPERSEDED_TAG 1
+#define FRAME_LENGTH_SIZE 2
+
+// Orders the accesses to a queue slot with those to the position that hands it over to the other context
+#if defined(__AVR__)
+#define MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+#if NEXTION_ENABLE_METRICS
+#define COUNT_METRIC(statement) m_metrics.statement
+#else
+#define COUNT_METRIC(statement)
+#endif
+
+NextionInterfaceBase::NextionInterfaceBase(Stream &stream, uint8_t *rxBuffer, uint16_t rxBufferSize, uint8_t *txBuffer, uint16_t txBufferSize, NextionRequest *requests, uint8_t maxRequests, const NextionComponent **components, size_t maxComponents)
     : m_stream(&stream),
+      m_buffer(rxBuffer),
+      m_bufferSize(rxBufferSize),
       m_currentIndex(0),
-      m_componentYear(new NextionComponent(0, 0, "rtc0")),
-      m_componentMonth(new NextionComponent(0, 0, "rtc1")),
-      m_componentDay(new NextionComponent(0, 0, "rtc2")),
-      m_componentHour(new NextionComponent(0, 0, "rtc3")),
-      m_componentMinute(new NextionComponent(0, 0, "rtc4")),
-      m_componentSecond(new NextionComponent(0, 0, "rtc5")),
-      m_componentDayOfTheWeek(new NextionComponent(0, 0, "rtc6"))
+      m_frame(rxBuffer),
+      m_frameSize(0),
+      m_expectedLength(0),
+      m_terminationBytesSeen(0),
+      m_isDiscarding(false),
+      m_txBuffer(txBuffer),
+      m_txBufferSize(txBufferSize),
+      m_stagedSize(0),
+      m_isStaging(false),
+      m_flushDelay(0),
+      m_batchStartedAt(0),
+      m_requests(requests),
+      m_maxRequests(maxRequests),
+      m_requestHead(0),
+      m_requestCount(0),
+      m_shadowEntries(nullptr),
+      m_rateLimits(nullptr),
+      m_window(nullptr),
+      m_windowSize(0),
+      m_windowHead(0),
+      m_windowCount(0),
+      m_untrackedCount(0),
+      m_maxRetries(0),
+      m_nextCommandId(0),
+      m_lastCommandId(0),
+      m_lastReplyAt(0),
+      m_flowBudget(0),
+      m_drainRate(0),
+      m_flowBackoff(0),
+      m_backedOffAt(0),
+      m_bytesInFlight(0),
+      m_drainedAt(0),
+      m_resendBytes(0),
+      m_isPageIdReceived(false),
+      m_isReadyReceived(false),
+      m_touchX(0),
+      m_touchY(0),
+      m_isTouchPressed(false),
+      m_isTouchMovePending(false),
+      m_currentPageId(0),
+      m_isCurrentPageKnown(false),
+      m_isSleeping(false),
+      m_isDeferredReleasePending(false),
+      m_events(nullptr),
+      m_eventCapacity(0),
+      m_eventTexts(nullptr),
+      m_eventTextSize(0),
+      m_eventHead(0),
+      m_eventTail(0),
+      m_isEventQueueFull(false),
+      m_droppedEvents(0),
+      m_eventOverflows(0),
+      m_receivedFrames(nullptr),
+      m_receivedCapacity(0),
+      m_receivedHead(0),
+      m_receivedTail(0),
+      m_droppedReceivedFrames(0),
+      m_waveformChannels(nullptr),
+      m_nextWaveformChannel(nullptr),
+      m_isWaveformBusy(false),
+      m_isTransparentDataPending(false),
+      m_isTransparentDataReady(false),
+      m_waveformStartedAt(0),
+      m_waveformBlockSize(0),
+      m_pendingRtcFields(0),
+      m_isRtcRequestFailed(false)
 {
-    m_componentYear->onNumericDataReceived = [](int32_t value)
+    if (components != nullptr)
     {
-        dateTime.year = static_cast<uint16_t>(value);
-    };
+        m_components.setStorage(components, maxComponents);
+    }
+}
 
-    m_componentMonth->onNumericDataReceived = [](int32_t value)
-    {
-        dateTime.month = static_cast<uint8_t>(value);
-    };
+void NextionInterfaceBase::registerComponent(const NextionComponent &component)
+{
+    m_components.add(component);
+}
+
+const NextionComponent *NextionInterfaceBase::getComponent(uint8_t pageId, ComponentId componentId)
+{
+    return m_components.find(pageId, componentId);
+}
 
-    m_componentDay->onNumericDataReceived = [](int32_t value)
+void NextionInterfaceBase::clearBuffer()
+{
+    if (m_receivedFrames != nullptr)
+    {
+        // The stream and the framing belong to receive(), only what it has queued is dropped
+        m_receivedHead = m_receivedTail;
+    }
+    else
     {
-        dateTime.day = static_cast<uint8_t>(value);
-    };
+        while (m_stream->available())
+        {
+            delay(10);
+            m_stream->read();
+        }
+
+        m_currentIndex = 0;
+        m_isDiscarding = false;
+    }
+
+    // Their replies may have just been discarded
+    m_requestCount = 0;
+    m_pendingRtcFields = 0;
+    discardCommands();
+}
 
-    m_componentHour->onNumericDataReceived = [](int32_t value)
+bool NextionInterfaceBase::update()
+{
+    // Roughly 1 ms per sample at 9600 baud, in case the end of the block is never reported
+    if (m_isWaveformBusy && millis() - m_waveformStartedAt >= TIMEOUT + static_cast<unsigned long>(m_waveformBlockSize))
     {
-        dateTime.hour = static_cast<uint8_t>(value);
-    };
+        m_isWaveformBusy = false;
+    }
 
-    m_componentMinute->onNumericDataReceived = [](int32_t value)
+    if (!m_isWaveformBusy)
     {
-        dateTime.minute = static_cast<uint8_t>(value);
-    };
+        streamWaveformChannels();
+    }
+
+    releaseRateLimitedValues();
 
-    m_componentSecond->onNumericDataReceived = [](int32_t value)
+    if (m_isDeferredReleasePending)
     {
-        dateTime.second = static_cast<uint8_t>(value);
-    };
+        releaseDeferredWrites();
+    }
 
-    m_componentDayOfTheWeek->onNumericDataReceived = [](int32_t value)
+    if (!m_txQueue.isEmpty() && millis() - m_batchStartedAt >= m_flushDelay)
     {
-        dateTime.dayOfTheWeek = static_cast<uint8_t>(value);
-    };
-}
+        flush();
+    }
 
-NextionInterface::~NextionInterface()
-{
-    delete m_componentYear;
-    delete m_componentMonth;
-    delete m_componentDay;
-    delete m_componentHour;
-    delete m_componentMinute;
-    delete m_componentSecond;
-    delete m_componentDayOfTheWeek;
-}
+    expireRequests();
+    expireCommands();
 
-void NextionInterface::registerComponent(NextionComponent &component)
-{
-    m_components.add(&component);
-}
+    auto isFrameProcessed = false;
 
-NextionComponent *NextionInterface::getComponent(uint8_t pageId, ComponentId componentId)
-{
-    for (size_t i = 0; i < m_components.size(); i++)
+    if (m_receivedFrames != nullptr)
     {
-        const auto component = m_components.get(i);
-        if (component->id() == componentId && component->pageId() == pageId)
+        isFrameProcessed = processReceivedFrames();
+    }
+
+    const auto startedAt = millis();
+
+    while (m_receivedFrames == nullptr && m_stream->available() > 0 && millis() - startedAt < TIMEOUT)
+    {
+        COUNT_METRIC(rxBytes++);
+
+        if (!parse(static_cast<uint8_t>(m_stream->read())))
+        {
+            continue;
+        }
+
+        if (processFrame(m_buffer, m_currentIndex))
         {
-            return component;
+            isFrameProcessed = true;
         }
+
+        m_currentIndex = 0;
     }
 
-    return nullptr;
+    // After the results just read have made room
+    releaseHeldFrames(false);
+
+    emitTouchMove();
+    return isFrameProcessed;
 }
 
-void NextionInterface::clearBuffer()
+void NextionInterfaceBase::enableReceiveQueue(uint8_t *frames, size_t size)
 {
-    while (m_stream->available())
-    {
-        delay(10);
-        m_stream->read();
-    }
+    // Each slot holds the length of its frame followed by room for the largest one
+    const auto capacity = size / (m_bufferSize + FRAME_LENGTH_SIZE);
+    m_receivedCapacity = capacity < 128 ? static_cast<uint8_t>(capacity) : 127;
+    m_receivedHead = 0;
+    m_receivedTail = 0;
+    m_currentIndex = 0;
+    m_isDiscarding = false;
+    MEMORY_BARRIER();
+    m_receivedFrames = m_receivedCapacity > 0 ? frames : nullptr;
+}
+
+void NextionInterfaceBase::disableReceiveQueue()
+{
+    // What was received is still decoded, the rest is read by update() again
+    (void)processReceivedFrames();
+    m_receivedFrames = nullptr;
+    m_receivedCapacity = 0;
+    m_frame = m_buffer;
 }
 
-bool NextionInterface::update()
+uint8_t NextionInterfaceBase::receive()
 {
-    if (!m_stream->available())
+    uint8_t received = 0;
+
+    if (m_receivedFrames == nullptr)
     {
-        return false;
+        return received;
     }
 
-    const auto shouldUnblockAt = millis() + TIMEOUT;
+    const auto queueSize = static_cast<uint8_t>(2 * m_receivedCapacity);
 
-    while (m_stream->available() && millis() < shouldUnblockAt)
+    while (m_stream->available() > 0)
     {
-        if (m_currentIndex >= NextionConstants::MAX_BUFFER_SIZE)
+        if (!parse(static_cast<uint8_t>(m_stream->read())))
         {
-            // Buffer overflow
-            m_currentIndex = 0;
+            continue;
         }
 
-        m_buffer[m_currentIndex] = m_stream->read();
-        const auto returnCode = static_cast<NextionConstants::ReturnCode>(m_buffer[0]);
+        const uint8_t tail = m_receivedTail;
 
-        if (!isBufferTerminated())
+        if ((tail - m_receivedHead + queueSize) % queueSize == m_receivedCapacity)
         {
-            m_currentIndex++;
+            // Full, the newest frame is dropped
+            m_droppedReceivedFrames++;
+            m_currentIndex = 0;
             continue;
         }
 
-        if (processBuffer())
-        {
-            return true;
-        }
+        auto *slot = receivedFrameAt(tail);
+        slot[0] = static_cast<uint8_t>(m_currentIndex);
+        slot[1] = static_cast<uint8_t>(m_currentIndex >> 8);
+        memcpy(&slot[FRAME_LENGTH_SIZE], m_buffer, m_currentIndex);
+        m_currentIndex = 0;
+
+        // The frame is complete before update() can see it
+        MEMORY_BARRIER();
+        m_receivedTail = (tail + 1) % queueSize;
+        received++;
     }
 
-    return false;
+    return received;
 }
 
-void NextionInterface::reset()
+uint32_t NextionInterfaceBase::droppedReceivedFrameCount() const
 {
-    sendCommand(NextionConstants::Command::Reset);
+    return m_droppedReceivedFrames;
 }
 
-void NextionInterface::sendRaw(const char *raw)
+void NextionInterfaceBase::enableEventQueue(NextionEvent *events, uint8_t capacity, char *texts, uint16_t textSize)
 {
-    m_stream->print(raw);
-    writeTerminationBytes();
+    dispatch();
+
+    // Positions run over twice the capacity so that a full queue can be told from an empty one
+    m_eventCapacity = capacity < 128 ? capacity : 127;
+    m_events = m_eventCapacity > 0 ? events : nullptr;
+    m_eventTexts = textSize > 0 ? texts : nullptr;
+    m_eventTextSize = m_eventTexts != nullptr ? textSize : 0;
+    m_eventHead = 0;
+    m_eventTail = 0;
 }
 
-void NextionInterface::setText(const NextionComponent &component, const char *value)
+void NextionInterfaceBase::disableEventQueue()
 {
-    setText(component.name(), value);
+    dispatch();
+    m_events = nullptr;
+    m_eventCapacity = 0;
 }
 
-void NextionInterface::setInteger(const NextionComponent &component, int value)
+uint8_t NextionInterfaceBase::dispatch(uint8_t maxEvents)
 {
-    setInteger(component.name(), value);
-}
+    uint8_t dispatched = 0;
 
-void NextionInterface::getText(NextionComponent &component)
-{
-    m_componentRetrievingText = &component;
-    getText(component.name());
+    while (m_events != nullptr && dispatched < maxEvents && m_eventHead != m_eventTail)
+    {
+        // Copied out, the slot is free again once the callback runs
+        MEMORY_BARRIER();
+        auto event = m_events[m_eventHead % m_eventCapacity];
+        MEMORY_BARRIER();
+        m_eventHead = (m_eventHead + 1) % (2 * m_eventCapacity);
+        deliverEvent(event);
+        dispatched++;
+    }
+
+    return dispatched;
 }
 
-void NextionInterface::getInteger(NextionComponent &component)
+uint8_t NextionInterfaceBase::pendingEventCount() const
 {
-    m_componentRetrievingInteger = &component;
-    getInteger(component.name());
+    if (m_events == nullptr)
+    {
+        return 0;
+    }
+
+    const auto queueSize = 2 * m_eventCapacity;
+    return (m_eventTail - m_eventHead + queueSize) % queueSize;
 }
 
-void NextionInterface::getCurrentPageId()
+uint32_t NextionInterfaceBase::droppedEventCount() const
 {
-    sendCommand(NextionConstants::Command::GetPageId);
+    return m_droppedEvents;
 }
 
-void NextionInterface::convertTextToNumeric(const char *sourceObjectName, const char *destinationObjectName, uint8_t length, NextionConstants::ConversionFormat format)
+uint32_t NextionInterfaceBase::eventOverflowCount() const
 {
-    char src[strlen(sourceObjectName) + strlen(NextionConstants::TEXT_ATTRIBUTE) + 1];
-    char dest[strlen(destinationObjectName) + strlen(NextionConstants::NUMERIC_ATTRIBUTE) + 1];
-    sprintf(src, "%s%s", sourceObjectName, NextionConstants::TEXT_ATTRIBUTE);
-    sprintf(dest, "%s%s", destinationObjectName, NextionConstants::NUMERIC_ATTRIBUTE);
-    convert(src, dest, length, format);
+    return m_eventOverflows;
 }
 
-void NextionInterface::convertTextToNumeric(const NextionComponent &source, const NextionComponent &destination, uint8_t length, NextionConstants::ConversionFormat format)
+void NextionInterfaceBase::enableDeferredWrites(uint8_t *buffer, size_t size)
 {
-    convertTextToNumeric(source.name(), destination.name(), length, format);
+    m_deferredWrites.setStorage(buffer, size);
 }
 
-void NextionInterface::convertNumericToText(const char *sourceObjectName, const char *destinationObjectName, uint8_t length, NextionConstants::ConversionFormat format)
+void NextionInterfaceBase::disableDeferredWrites()
 {
-    char src[strlen(sourceObjectName) + strlen(NextionConstants::TEXT_ATTRIBUTE) + 1];
-    char dest[strlen(destinationObjectName) + strlen(NextionConstants::NUMERIC_ATTRIBUTE) + 1];
-    sprintf(src, "%s%s", sourceObjectName, NextionConstants::NUMERIC_ATTRIBUTE);
-    sprintf(dest, "%s%s", destinationObjectName, NextionConstants::TEXT_ATTRIBUTE);
-    convert(src, dest, length, format);
+    // The writes held are dropped, the display never got the values cached for them
+    NextionFrameQueue::Record record;
+
+    for (size_t offset = 0; m_deferredWrites.next(offset, record);)
+    {
+        invalidateShadowCache(record.tag);
+    }
+
+    m_deferredWrites.setStorage(nullptr, 0);
 }
 
-void NextionInterface::convertNumericToText(const NextionComponent &source, const NextionComponent &destination, uint8_t length, NextionConstants::ConversionFormat format)
+bool NextionInterfaceBase::isCurrentPageKnown() const
 {
-    convertNumericToText(source.name(), destination.name(), length, format);
+    return m_isCurrentPageKnown;
 }
 
-void NextionInterface::setVisibility(const char *componentName, bool visible)
+uint8_t NextionInterfaceBase::currentPageId() const
 {
-    writeCommand(NextionConstants::Command::SetVisibility);
-    sendParameterList(componentName, visible ? 1 : 0);
-    writeTerminationBytes();
+    return m_currentPageId;
 }
 
-void NextionInterface::setVisibility(const NextionComponent &component, bool visible)
+void NextionInterfaceBase::enableBatching(uint8_t *buffer, size_t size, uint16_t flushDelay)
 {
-    setVisibility(component.name(), visible);
+    flush();
+    m_txQueue.setStorage(buffer, size);
+    m_flushDelay = flushDelay;
 }
 
-void NextionInterface::sleep(bool isSleep)
+void NextionInterfaceBase::disableBatching()
 {
-    sendCommand(NextionConstants::Command::Sleep, isSleep);
+    flush();
+    m_txQueue.setStorage(nullptr, 0);
 }
 
-void NextionInterface::setDate(uint8_t day, uint8_t month, uint16_t year)
+bool NextionInterfaceBase::isBatching() const
 {
-    set(NextionConstants::Command::RtcDay, day);
-    set(NextionConstants::Command::RtcMonth, month);
-    set(NextionConstants::Command::RtcYear, year);
+    return m_txQueue.hasStorage();
 }
 
-void NextionInterface::getDate()
+void NextionInterfaceBase::flush()
 {
-    const NextionConstants::Command commands[] = {NextionConstants::Command::RtcDay,
-                                                  NextionConstants::Command::RtcMonth,
-                                                  NextionConstants::Command::RtcYear,
-                                                  NextionConstants::Command::RtcDayOfTheWeek};
-    NextionComponent *rtcDateComponents[] = {m_componentDay,
-                                             m_componentMonth,
-                                             m_componentYear,
-                                             m_componentDayOfTheWeek};
+    if (m_txQueue.isEmpty() || m_isTransparentDataPending)
+    {
+        return;
+    }
 
-    for (auto i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+    if (isPacing())
     {
-        const auto timeoutAt = millis() + 100;
-        m_componentRetrievingInteger = rtcDateComponents[i];
-        clearBuffer();
-        get(commands[i]);
+        creditDrainedBytes();
 
-        while (millis() < timeoutAt)
+        if (m_heldFrames.isEmpty())
         {
-            if (update())
-            {
-                break;
-            }
+            writeCreditedFrames(m_txQueue, false);
         }
-    }
-}
-
-void NextionInterface::setTime(uint8_t hour, uint8_t minute, uint8_t second)
-{
-    set(NextionConstants::Command::RtcHour, hour);
-    set(NextionConstants::Command::RtcMinute, minute);
-    set(NextionConstants::Command::RtcSecond, second);
-}
-
-void NextionInterface::getTime()
-{
-    const NextionConstants::Command commands[] = {NextionConstants::Command::RtcHour,
-                                                  NextionConstants::Command::RtcMinute,
-                                                  NextionConstants::Command::RtcSecond};
-    NextionComponent *rtcTimeComponents[] = {m_componentHour,
-                                             m_componentMinute,
-                                             m_componentSecond};
 
-    for (auto i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
-    {
-        const auto timeoutAt = millis() + 100;
-        m_componentRetrievingInteger = rtcTimeComponents[i];
-        clearBuffer();
-        get(commands[i]);
+        // The rest waits for the display to have taken what was written
+        NextionFrameQueue::Record record;
 
-        while (millis() < timeoutAt)
+        for (size_t offset = 0; m_txQueue.next(offset, record);)
         {
-            if (update())
-            {
-                break;
-            }
+            paceFrame(record.frame, record.length, record.keyLength, static_cast<NextionConstants::ReturnCode>(record.tag));
         }
-    }
-}
 
-char *NextionInterface::getDayOfTheWeek(NextionConstants::DayOfTheWeek day)
-{
-    switch (day)
-    {
-    case NextionConstants::DayOfTheWeek::Sunday:
-    {
-        return "Sunday";
-    }
-    case NextionConstants::DayOfTheWeek::Monday:
-    {
-        return "Monday";
-    }
-    case NextionConstants::DayOfTheWeek::Tuesday:
-    {
-        return "Tuesday";
+        m_txQueue.clear();
+        return;
     }
-    case NextionConstants::DayOfTheWeek::Wednesday:
-    {
-        return "Wednesday";
-    }
-    case NextionConstants::DayOfTheWeek::Thursday:
-    {
-        return "Thursday";
-    }
-    case NextionConstants::DayOfTheWeek::Friday:
-    {
-        return "Friday";
-    }
-    case NextionConstants::DayOfTheWeek::Saturday:
+
+    NextionFrameQueue::Record record;
+
+    for (size_t offset = 0; m_txQueue.next(offset, record);)
     {
-        return "Saturday";
-    }
+        trackFrame(record.frame, record.length, record.keyLength, static_cast<NextionConstants::ReturnCode>(record.tag));
     }
+
+    const auto size = m_txQueue.pack();
+    transmit(m_txQueue.data(), size);
+    m_txQueue.clear();
 }
 
-void NextionInterface::setBackgroundColor(const NextionComponent &component, const NextionConstants::Color color)
+void NextionInterfaceBase::enableAcknowledgements(NextionPendingCommand *window, uint8_t windowSize, uint8_t *retryBuffer, size_t retryBufferSize, uint8_t maxRetries)
 {
-    setBackgroundColor(component.name(), static_cast<uint16_t>(color));
+    // Whatever is queued runs before the return level changes
+    flush();
+    discardCommands();
+
+    m_window = windowSize > 0 ? window : nullptr;
+    m_windowSize = m_window != nullptr ? windowSize : 0;
+    m_windowHead = 0;
+    m_maxRetries = maxRetries;
+    m_retryQueue.setStorage(retryBuffer, retryBufferSize);
+
+    // Tracked as well, its result is reported at the new level
+    set(NextionConstants::Command::SetReturnLevel, static_cast<uint8_t>(NextionConstants::ReturnLevel::Always));
 }
 
-void NextionInterface::setBackgroundColor2(const NextionComponent &component, const NextionConstants::Color color)
+void NextionInterfaceBase::disableAcknowledgements()
 {
-    setBackgroundColor2(component.name(), static_cast<uint16_t>(color));
+    flush();
+    discardCommands();
+
+    m_window = nullptr;
+    m_windowSize = 0;
+    m_retryQueue.setStorage(nullptr, 0);
+
+    set(NextionConstants::Command::SetReturnLevel, static_cast<uint8_t>(NextionConstants::ReturnLevel::OnFailure));
 }
 
-void NextionInterface::setForegroundColor(const NextionComponent &component, const NextionConstants::Color color)
+bool NextionInterfaceBase::isAcknowledging() const
 {
-    setForegroundColor(component.name(), static_cast<uint16_t>(color));
+    return m_window != nullptr;
 }
 
-void NextionInterface::setForegroundColor2(const NextionComponent &component, const NextionConstants::Color color)
+uint16_t NextionInterfaceBase::lastCommandId() const
 {
-    setForegroundColor2(component.name(), static_cast<uint16_t>(color));
+    return m_lastCommandId;
 }
 
-void NextionInterface::setBackgroundColor(const NextionComponent &component, const uint16_t color)
+uint8_t NextionInterfaceBase::unacknowledgedCount() const
 {
-    setBackgroundColor(component.name(), color);
+    return m_windowCount;
 }
 
-void NextionInterface::setBackgroundColor2(const NextionComponent &component, const uint16_t color)
+void NextionInterfaceBase::enableFlowControl(uint8_t *holdBuffer, size_t holdBufferSize, uint8_t *resendBuffer, size_t resendBufferSize, uint16_t budget, uint32_t drainRate)
 {
-    setBackgroundColor2(component.name(), color);
+    releaseHeldFrames(true);
+
+    m_heldFrames.setStorage(holdBuffer, holdBufferSize);
+    m_resendFrames.setStorage(resendBuffer, resendBufferSize);
+    m_resendBytes = 0;
+    m_flowBudget = budget;
+    m_drainRate = drainRate > 0 ? drainRate : 1;
+    m_flowBackoff = 0;
+
+    // What was sent before is not accounted for
+    m_bytesInFlight = 0;
 }
 
-void NextionInterface::setForegroundColor(const NextionComponent &component, const uint16_t color)
+void NextionInterfaceBase::disableFlowControl()
 {
-    setForegroundColor(component.name(), color);
+    releaseHeldFrames(true);
+
+    m_heldFrames.setStorage(nullptr, 0);
+    m_resendFrames.setStorage(nullptr, 0);
+    m_resendBytes = 0;
+    m_flowBudget = 0;
+    m_bytesInFlight = 0;
 }
 
-void NextionInterface::setForegroundColor2(const NextionComponent &component, const uint16_t color)
+bool NextionInterfaceBase::isPacing() const
 {
-    setForegroundColor2(component.name(), color);
+    return m_flowBudget > 0;
 }
 
-void NextionInterface::setBackgroundColor(const char *objectName, const uint16_t color)
+uint32_t NextionInterfaceBase::bytesInFlight() const
 {
-    setColor(objectName, NextionConstants::BACKGROUND_ATTRIBUTE, color);
+    return m_bytesInFlight;
 }
 
-void NextionInterface::setBackgroundColor2(const char *objectName, const uint16_t color)
+#if NEXTION_ENABLE_METRICS
+NextionMetrics NextionInterfaceBase::metrics() const
 {
-    setColor(objectName, NextionConstants::BACKGROUND_2_ATTRIBUTE, color);
+    return m_metrics;
 }
 
-void NextionInterface::setForegroundColor(const char *objectName, const uint16_t color)
+void NextionInterfaceBase::resetMetrics()
 {
-    setColor(objectName, NextionConstants::FOREGROUND_ATTRIBUTE, color);
+    m_metrics = NextionMetrics{};
 }
+#endif
 
-void NextionInterface::setForegroundColor2(const char *objectName, const uint16_t color)
+void NextionInterfaceBase::reset()
 {
-    setColor(objectName, NextionConstants::FOREGROUND_2_ATTRIBUTE, color);
+    sendCommand(NextionConstants::Command::Reset);
+    invalidateShadowCache();
 }
 
-DateTime NextionInterface::getDateTime()
+void NextionInterfaceBase::sendRaw(const char *raw)
 {
-    getDate();
-    getTime();
-    return dateTime;
-}
+    auto frame = beginFrame();
+    frame.append(raw);
 
-// Private methods
+    if (!frame.fits(0))
+    {
+        frame.makeRoom();
+    }
 
-bool NextionInterface::waitForResponse()
-{
-    const auto unblockAt = millis() + TIMEOUT;
+    if (frame.fits(0))
+    {
+        sendFrame(frame);
+        return;
+    }
 
-    while (millis() < unblockAt)
+    // Too long for the transmit buffer, send it as is
+    if (beginStreamedFrame())
     {
-        if (update())
-        {
-            return true;
-        }
+        transmit(reinterpret_cast<const uint8_t *>(raw), strlen(raw));
+        endStreamedFrame();
     }
+}
 
-    return false;
+bool NextionInterfaceBase::probe()
+{
+    m_isPageIdReceived = false;
+    getCurrentPageId();
+    flush();
+    return waitForPageId();
 }
 
-bool NextionInterface::isBufferTerminated()
+bool NextionInterfaceBase::changeBaudRate(uint32_t currentBaudRate, uint32_t baudRate)
 {
-    if (m_currentIndex < NextionConstants::TERMINATION_BYTES_SIZE)
+    if (onBaudRateChange == nullptr)
     {
         return false;
     }
 
-    for (auto i = 0; i < NextionConstants::TERMINATION_BYTES_SIZE; i++)
+    flush();
+    set(NextionConstants::Command::BaudRate, baudRate);
+    flush();
+    switchHostBaudRate(baudRate);
+
+    if (probe())
     {
-        if (NextionConstants::TERMINATION_BYTES[i] != m_buffer[m_currentIndex - NextionConstants::TERMINATION_BYTES_SIZE + i + 1])
-        {
-            return false;
-        }
+        return true;
     }
 
-    return true;
+    // The display may have switched but be unreachable at that rate, ask it to go back blindly
+    set(NextionConstants::Command::BaudRate, currentBaudRate);
+    flush();
+    switchHostBaudRate(currentBaudRate);
+    return false;
 }
 
-bool NextionInterface::processBuffer()
+NextionStartupReport NextionInterfaceBase::begin(const NextionStartupOptions &options)
 {
     using namespace NextionConstants;
-    const auto returnCode = static_cast<ReturnCode>(m_buffer[0]);
 
-    switch (returnCode)
-    {
-    case ReturnCode::TouchEvent:
+    NextionStartupReport report{};
+    report.baudRate = options.baudRate;
+    const auto startedAt = millis();
+
+    // A display that is already up answers the probe, one still booting reports when it is ready
+    m_isReadyReceived = false;
+    m_isPageIdReceived = false;
+    auto probedAt = millis();
+    getCurrentPageId();
+    flush();
+
+    while (!m_isReadyReceived && !m_isPageIdReceived)
     {
-        if (payloadSize() != ExpectedPayloadSize::TOUCH_EVENT)
+        if (millis() - startedAt >= options.readyTimeout)
         {
-            m_currentIndex = 0;
-            return false;
+            return report;
         }
 
-        const auto component = getComponent(m_buffer[1], m_buffer[2]);
+        update();
 
-        if (component != nullptr && component->onTouchEvent != nullptr)
+        if (millis() - probedAt >= TIMEOUT)
         {
-            component->onTouchEvent(static_cast<ClickEvent>(m_buffer[3]));
-            return false;
+            probedAt = millis();
+            getCurrentPageId();
+            flush();
         }
+    }
 
-        if (onTouchEvent == nullptr)
-        {
-            return false;
-        }
+    report.isReady = true;
+    report.timeToReady = millis() - startedAt;
 
-        m_currentIndex = 0;
-        onTouchEvent(m_buffer[1], m_buffer[2], static_cast<ClickEvent>(m_buffer[3]));
-        return true;
-    }
-    case ReturnCode::CurrentPageId:
+    if (options.maxBaudRate > options.baudRate)
     {
-        if (onPageIdUpdated == nullptr || payloadSize() != ExpectedPayloadSize::CURRENT_PAGE_NUMBER)
-        {
-            m_currentIndex = 0;
-            return false;
-        }
-
-        m_currentIndex = 0;
-        onPageIdUpdated(m_buffer[1]);
-        return true;
+        report.baudRate = negotiateBaudRate(options.baudRate, options.maxBaudRate);
     }
-    case ReturnCode::NumericDataEnclosed:
-    {
-        if (m_componentRetrievingInteger == nullptr)
-        {
-            return false;
-        }
-
-        if (payloadSize() < ExpectedPayloadSize::NUMERIC_DATA_ENCLOSED)
-        {
-            m_currentIndex++;
-            return false;
-        }
-        else if (payloadSize() > ExpectedPayloadSize::NUMERIC_DATA_ENCLOSED)
-        {
-            m_currentIndex = 0;
-            return false;
-        }
 
-        int32_t numericValue = m_buffer[1] | m_buffer[2] << 8 | m_buffer[3] << 16 | m_buffer[4] << 24;
+    // Staged so that the settings, the initial state and the probe go out in one write
+    beginStaging();
 
-        if (numericValue >> 31 & 1) // Two's complement
-        {
-            numericValue = ~numericValue;
-            numericValue += 1;
-            numericValue *= -1;
-        }
+    if (!isAcknowledging())
+    {
+        set(Command::SetReturnLevel, static_cast<uint8_t>(options.returnLevel));
+    }
 
-        m_currentIndex = 0;
+    set(Command::SendTouchCoordinates, options.isTouchCoordinateReported ? 1 : 0);
+    set(Command::WakeOnTouch, options.isWokenByTouch ? 1 : 0);
 
-        if (m_componentRetrievingInteger->onNumericDataReceived != nullptr)
-        {
-            m_componentRetrievingInteger->onNumericDataReceived(numericValue);
-        }
+    if (onInitialState != nullptr)
+    {
+        onInitialState();
+    }
 
-        if (onNumericDataReceived != nullptr)
-        {
-            onNumericDataReceived(m_componentRetrievingInteger, numericValue);
-        }
+    // Answered once everything before it has been taken
+    m_isPageIdReceived = false;
+    getCurrentPageId();
+    endStaging();
 
-        return true;
-    }
-    case ReturnCode::StringDataEnclosed:
+    if (waitForPageId() && onInitialState != nullptr)
     {
-        if (onStringDataReceived == nullptr || m_componentRetrievingText == nullptr)
-        {
-            m_currentIndex = 0;
-            return false;
-        }
+        report.timeToFirstFrame = millis() - startedAt;
+    }
 
-        const auto dataLength = payloadSize();
-        char payload[dataLength];
+    return report;
+}
 
-        for (auto i = 0; i < dataLength - 1; i++)
-        {
-            payload[i] = m_buffer[i + 1];
-        }
+uint32_t NextionInterfaceBase::negotiateBaudRate(uint32_t currentBaudRate, uint32_t maxBaudRate)
+{
+    using namespace NextionConstants;
 
-        payload[dataLength - 1] = '\0';
-        m_currentIndex = 0;
+    for (auto i = SUPPORTED_BAUD_RATE_COUNT; i-- > 0;)
+    {
+        const auto baudRate = SUPPORTED_BAUD_RATES[i];
 
-        if (m_componentRetrievingText->onStringDataReceived != nullptr)
-        {
-            m_componentRetrievingText->onStringDataReceived(payload);
-        }
-        else
+        if (baudRate <= currentBaudRate)
         {
-            onStringDataReceived(m_componentRetrievingText, payload);
+            break;
         }
 
-        return true;
-    }
-    default:
-    {
-        m_currentIndex = 0;
-        if (onUnhandledReturnCodeReceived)
+        if (baudRate <= maxBaudRate && changeBaudRate(currentBaudRate, baudRate))
         {
-            onUnhandledReturnCodeReceived(m_buffer[0]);
+            return baudRate;
         }
-
-        return false;
-    }
     }
 
-    return false;
+    return currentBaudRate;
 }
 
-uint8_t NextionInterface::payloadSize()
+void NextionInterfaceBase::saveBaudRate(uint32_t baudRate)
 {
-    return m_currentIndex - NextionConstants::TERMINATION_BYTES_SIZE + 1;
+    set(NextionConstants::Command::DefaultBaudRate, baudRate);
 }
 
-void NextionInterface::writeTerminationBytes()
+void NextionInterfaceBase::enableShadowCache(const NextionComponent &component, NextionShadowEntry &entry)
 {
-    for (auto i = 0; i < NextionConstants::TERMINATION_BYTES_SIZE; i++)
+    if (entry.m_component != nullptr)
     {
-        m_stream->write(NextionConstants::TERMINATION_BYTES[i]);
+        // Already in use
+        return;
     }
-}
 
-void NextionInterface::writeCommand(const NextionConstants::Command &command)
-{
-    m_stream->print(getCommand(command));
-    m_stream->print(NextionConstants::COMMAND_SEPARATOR);
+    entry.m_component = &component;
+    entry.invalidate();
+    entry.m_next = m_shadowEntries;
+    m_shadowEntries = &entry;
 }
 
-const char *NextionInterface::getCommand(const NextionConstants::Command &command)
+void NextionInterfaceBase::invalidateShadowCache()
 {
-    using namespace NextionConstants;
-
-    switch (command)
-    {
-    case Command::Reset:
+    for (auto entry = m_shadowEntries; entry != nullptr; entry = entry->m_next)
     {
-        return "rest";
+        entry->invalidate();
     }
-    case Command::Get:
+
+    // The deadband is measured from what the display shows, which is no longer known
+    for (auto limit = m_rateLimits; limit != nullptr; limit = limit->m_next)
     {
-        return "get";
+        limit->m_hasSentValue = false;
     }
-    case Command::ChangePage:
+}
+
+void NextionInterfaceBase::invalidateShadowCache(uint8_t pageId)
+{
+    for (auto entry = m_shadowEntries; entry != nullptr; entry = entry->m_next)
     {
-        return "page";
+        if (entry->m_component->pageId() == pageId)
+        {
+            entry->invalidate();
+        }
     }
-    case Command::Refresh:
+
+    for (auto limit = m_rateLimits; limit != nullptr; limit = limit->m_next)
     {
-        return "ref";
+        if (limit->m_component->pageId() == pageId)
+        {
+            limit->m_hasSentValue = false;
+        }
     }
-    case Command::Click:
+}
+
+void NextionInterfaceBase::invalidateShadowCache(const NextionComponent &component)
+{
+    const auto entry = findShadowEntry(component);
+
+    if (entry != nullptr)
     {
-        return "click";
+        entry->invalidate();
     }
-    case Command::GetPageId:
+
+    const auto limit = findRateLimit(component);
+
+    if (limit != nullptr)
     {
-        return "sendme";
+        limit->m_hasSentValue = false;
     }
-    case Command::Convert:
+}
+
+void NextionInterfaceBase::enableRateLimit(const NextionComponent &component, NextionRateLimit &limit, uint16_t minInterval, uint32_t deadband)
+{
+    if (limit.m_component != nullptr)
     {
-        return "covx";
+        // Already in use
+        return;
     }
-    case Command::SetVisibility:
+
+    limit.m_component = &component;
+    limit.m_minInterval = minInterval;
+    limit.m_deadband = deadband;
+    limit.m_hasSentValue = false;
+    limit.m_hasPendingValue = false;
+    limit.m_next = m_rateLimits;
+    m_rateLimits = &limit;
+}
+
+bool NextionInterfaceBase::addWaveformSamples(const NextionComponent &waveform, uint8_t channel, const uint8_t *samples, uint16_t count)
+{
+    if (!beginTransparentData(waveform, channel, count))
     {
-        return "vis";
+        return false;
     }
-    case Command::EnableTouchEvent:
+
+    transmit(samples, count);
+    return true;
+}
+
+void NextionInterfaceBase::registerWaveformChannel(NextionWaveformChannel &channel)
+{
+    for (auto registered = m_waveformChannels; registered != nullptr; registered = registered->m_next)
     {
-        return "tsw";
+        if (registered == &channel)
+        {
+            return;
+        }
     }
-    case Command::Sleep:
+
+    channel.m_next = m_waveformChannels;
+    m_waveformChannels = &channel;
+}
+
+bool NextionInterfaceBase::isStreamingWaveform() const
+{
+    return m_isWaveformBusy;
+}
+
+bool NextionInterfaceBase::setText(const NextionComponent &component, const char *value)
+{
+    return writeText(component, value);
+}
+
+void NextionInterfaceBase::setInteger(const NextionComponent &component, int value)
+{
+    if (isRateLimited(component, value))
+    {
+        return;
+    }
+
+    writeAttribute(component, NextionConstants::Attribute::Value, value);
+}
+
+void NextionInterfaceBase::setTexts(const NextionComponent *const *components, const char *const *values, size_t count)
+{
+    beginStaging();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        setText(*components[i], values[i]);
+    }
+
+    endStaging();
+}
+
+void NextionInterfaceBase::setIntegers(const NextionComponent *const *components, const int *values, size_t count)
+{
+    beginStaging();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (isRateLimited(*components[i], values[i]))
+        {
+            continue;
+        }
+
+        writeAttribute(*components[i], NextionConstants::Attribute::Value, values[i]);
+    }
+
+    endStaging();
+}
+
+void NextionInterfaceBase::setColors(const NextionComponent *const *components, NextionConstants::Attribute attribute, const uint16_t *colors, size_t count)
+{
+    using namespace NextionConstants;
+
+    if (attribute != Attribute::Background && attribute != Attribute::Background2 &&
+        attribute != Attribute::Foreground && attribute != Attribute::Foreground2)
+    {
+        return;
+    }
+
+    beginStaging();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        writeAttribute(*components[i], attribute, colors[i]);
+    }
+
+    endStaging();
+}
+
+bool NextionInterfaceBase::getText(const NextionComponent &component)
+{
+    if (!pushRequest(&component, NextionConstants::ReturnCode::StringDataEnclosed))
+    {
+        return false;
+    }
+
+    getAttribute(component, NextionConstants::Attribute::Text);
+    return true;
+}
+
+bool NextionInterfaceBase::getInteger(const NextionComponent &component)
+{
+    if (!pushRequest(&component, NextionConstants::ReturnCode::NumericDataEnclosed))
+    {
+        return false;
+    }
+
+    getAttribute(component, NextionConstants::Attribute::Value);
+    return true;
+}
+
+uint8_t NextionInterfaceBase::pendingRequestCount() const
+{
+    // Expired requests only hold their place
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < m_requestCount; i++)
+    {
+        if (!m_requests[(m_requestHead + i) % m_maxRequests].isExpired)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void NextionInterfaceBase::getCurrentPageId()
+{
+    sendCommand(NextionConstants::Command::GetPageId);
+
+#if NEXTION_ENABLE_METRICS
+    m_isPageIdRequested = true;
+    m_pageIdRequestedAt = millis();
+#endif
+}
+
+void NextionInterfaceBase::convertTextToNumeric(const char *sourceObjectName, const char *destinationObjectName, uint8_t length, NextionConstants::ConversionFormat format)
+{
+    convert(sourceObjectName, NextionConstants::Attribute::Text, destinationObjectName, NextionConstants::Attribute::Value, length, format);
+}
+
+void NextionInterfaceBase::convertTextToNumeric(const NextionComponent &source, const NextionComponent &destination, uint8_t length, NextionConstants::ConversionFormat format)
+{
+    convert(source, NextionConstants::Attribute::Text, destination, NextionConstants::Attribute::Value, length, format);
+}
+
+void NextionInterfaceBase::convertNumericToText(const char *sourceObjectName, const char *destinationObjectName, uint8_t length, NextionConstants::ConversionFormat format)
+{
+    convert(sourceObjectName, NextionConstants::Attribute::Value, destinationObjectName, NextionConstants::Attribute::Text, length, format);
+}
+
+void NextionInterfaceBase::convertNumericToText(const NextionComponent &source, const NextionComponent &destination, uint8_t length, NextionConstants::ConversionFormat format)
+{
+    convert(source, NextionConstants::Attribute::Value, destination, NextionConstants::Attribute::Text, length, format);
+}
+
+void NextionInterfaceBase::setVisibility(const char *componentName, bool visible)
+{
+    sendVisibility(componentName, visible);
+}
+
+void NextionInterfaceBase::setVisibility(const NextionComponent &component, bool visible)
+{
+    sendVisibility(component, visible);
+}
+
+void NextionInterfaceBase::sleep(bool isSleep)
+{
+    // Woken before the held writes are replayed
+    set(NextionConstants::Command::Sleep, isSleep ? 1 : 0);
+    setSleeping(isSleep);
+}
+
+bool NextionInterfaceBase::isSleeping() const
+{
+    return m_isSleeping;
+}
+
+void NextionInterfaceBase::setBrightness(uint8_t brightness)
+{
+    set(NextionConstants::Command::Brightness, brightness < 100 ? brightness : 100);
+}
+
+void NextionInterfaceBase::stopRefresh()
+{
+    sendCommand(NextionConstants::Command::StopRefresh);
+}
+
+void NextionInterfaceBase::startRefresh()
+{
+    sendCommand(NextionConstants::Command::StartRefresh);
+}
+
+void NextionInterfaceBase::setDate(uint8_t day, uint8_t month, uint16_t year)
+{
+    set(NextionConstants::Command::RtcDay, day);
+    set(NextionConstants::Command::RtcMonth, month);
+    set(NextionConstants::Command::RtcYear, year);
+}
+
+bool NextionInterfaceBase::getDate()
+{
+    const NextionConstants::Command fields[] = {NextionConstants::Command::RtcDay,
+                                                NextionConstants::Command::RtcMonth,
+                                                NextionConstants::Command::RtcYear,
+                                                NextionConstants::Command::RtcDayOfTheWeek};
+    return requestRtcFields(fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+void NextionInterfaceBase::setTime(uint8_t hour, uint8_t minute, uint8_t second)
+{
+    set(NextionConstants::Command::RtcHour, hour);
+    set(NextionConstants::Command::RtcMinute, minute);
+    set(NextionConstants::Command::RtcSecond, second);
+}
+
+bool NextionInterfaceBase::getTime()
+{
+    const NextionConstants::Command fields[] = {NextionConstants::Command::RtcHour,
+                                                NextionConstants::Command::RtcMinute,
+                                                NextionConstants::Command::RtcSecond};
+    return requestRtcFields(fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+bool NextionInterfaceBase::requestDateTime()
+{
+    const NextionConstants::Command fields[] = {NextionConstants::Command::RtcYear,
+                                                NextionConstants::Command::RtcMonth,
+                                                NextionConstants::Command::RtcDay,
+                                                NextionConstants::Command::RtcHour,
+                                                NextionConstants::Command::RtcMinute,
+                                                NextionConstants::Command::RtcSecond,
+                                                NextionConstants::Command::RtcDayOfTheWeek};
+    return requestRtcFields(fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+bool NextionInterfaceBase::isDateTimePending() const
+{
+    return m_pendingRtcFields > 0;
+}
+
+const DateTime &NextionInterfaceBase::dateTime() const
+{
+    return m_dateTime;
+}
+
+const __FlashStringHelper *NextionInterfaceBase::getDayOfTheWeek(NextionConstants::DayOfTheWeek day)
+{
+    const auto index = static_cast<uint8_t>(day);
+
+    if (index >= NextionConstants::DAY_COUNT)
+    {
+        // Still safe to print
+        return F("");
+    }
+
+    return reinterpret_cast<const __FlashStringHelper *>(NextionConstants::DAY_NAMES[index].name);
+}
+
+void NextionInterfaceBase::setBackgroundColor(const NextionComponent &component, const NextionConstants::Color color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Background, static_cast<uint16_t>(color));
+}
+
+void NextionInterfaceBase::setBackgroundColor2(const NextionComponent &component, const NextionConstants::Color color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Background2, static_cast<uint16_t>(color));
+}
+
+void NextionInterfaceBase::setForegroundColor(const NextionComponent &component, const NextionConstants::Color color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Foreground, static_cast<uint16_t>(color));
+}
+
+void NextionInterfaceBase::setForegroundColor2(const NextionComponent &component, const NextionConstants::Color color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Foreground2, static_cast<uint16_t>(color));
+}
+
+void NextionInterfaceBase::setBackgroundColor(const NextionComponent &component, const uint16_t color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Background, color);
+}
+
+void NextionInterfaceBase::setBackgroundColor2(const NextionComponent &component, const uint16_t color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Background2, color);
+}
+
+void NextionInterfaceBase::setForegroundColor(const NextionComponent &component, const uint16_t color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Foreground, color);
+}
+
+void NextionInterfaceBase::setForegroundColor2(const NextionComponent &component, const uint16_t color)
+{
+    writeAttribute(component, NextionConstants::Attribute::Foreground2, color);
+}
+
+void NextionInterfaceBase::setBackgroundColor(const char *objectName, const uint16_t color)
+{
+    setColor(objectName, NextionConstants::Attribute::Background, color);
+}
+
+void NextionInterfaceBase::setBackgroundColor2(const char *objectName, const uint16_t color)
+{
+    setColor(objectName, NextionConstants::Attribute::Background2, color);
+}
+
+void NextionInterfaceBase::setForegroundColor(const char *objectName, const uint16_t color)
+{
+    setColor(objectName, NextionConstants::Attribute::Foreground, color);
+}
+
+void NextionInterfaceBase::setForegroundColor2(const char *objectName, const uint16_t color)
+{
+    setColor(objectName, NextionConstants::Attribute::Foreground2, color);
+}
+
+DateTime NextionInterfaceBase::getDateTime()
+{
+    if (!requestDateTime())
+    {
+        return m_dateTime;
+    }
+
+    const auto startedAt = millis();
+
+    while (isDateTimePending() && millis() - startedAt < TIMEOUT)
+    {
+        update();
+    }
+
+    return m_dateTime;
+}
+
+// Private methods
+
+bool NextionInterfaceBase::waitForResponse()
+{
+    const auto unblockAt = millis() + TIMEOUT;
+
+    while (millis() < unblockAt)
+    {
+        if (update())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool NextionInterfaceBase::waitForPageId()
+{
+    const auto startedAt = millis();
+
+    while (!m_isPageIdReceived && millis() - startedAt < TIMEOUT)
+    {
+        update();
+    }
+
+    return m_isPageIdReceived;
+}
+
+bool NextionInterfaceBase::parse(uint8_t byte)
+{
+    using namespace NextionConstants;
+
+    if (m_isDiscarding)
+    {
+        // Skip everything up to the next terminator to resynchronise
+        m_terminationBytesSeen = byte == TERMINATION_BYTES[m_terminationBytesSeen] ? m_terminationBytesSeen + 1 : 0;
+
+        if (m_terminationBytesSeen == TERMINATION_BYTES_SIZE)
+        {
+            m_isDiscarding = false;
+            m_terminationBytesSeen = 0;
+        }
+
+        return false;
+    }
+
+    if (m_currentIndex == 0)
+    {
+        // Replies with a fixed length are framed by their length so that 0xFF bytes in the payload are
+        // kept. Anything else (e.g. string data) is framed by searching for the terminator.
+        m_expectedLength = getExpectedResponseLength(static_cast<ReturnCode>(byte));
+
+        if (m_expectedLength <= TERMINATION_BYTES_SIZE)
+        {
+            m_expectedLength = 0;
+        }
+    }
+
+    if (m_currentIndex >= m_bufferSize)
+    {
+        // Buffer overflow, the terminator may have begun in what was buffered
+        COUNT_METRIC(bufferOverflows++);
+        m_terminationBytesSeen = countTrailingTerminationBytes();
+        m_currentIndex = 0;
+        m_isDiscarding = true;
+        return parse(byte);
+    }
+
+    m_buffer[m_currentIndex++] = byte;
+
+    if (m_expectedLength == 0)
+    {
+        return isBufferTerminated();
+    }
+
+    if (m_currentIndex < m_expectedLength)
+    {
+        return false;
+    }
+
+    if (isBufferTerminated())
+    {
+        return true;
+    }
+
+    // Misaligned frame, drop it along with whatever follows up to the next terminator. Its last bytes may
+    // already be the start of that terminator, e.g. 00 00 00 FF FF FF sent on startup.
+    COUNT_METRIC(resyncs++);
+    m_terminationBytesSeen = countTrailingTerminationBytes();
+    m_currentIndex = 0;
+    m_isDiscarding = true;
+    return false;
+}
+
+// How many of the first termination bytes end the buffer, fewer than a whole terminator
+uint8_t NextionInterfaceBase::countTrailingTerminationBytes() const
+{
+    using namespace NextionConstants;
+
+    for (auto count = static_cast<uint8_t>(TERMINATION_BYTES_SIZE - 1); count > 0; count--)
+    {
+        if (count <= m_currentIndex && memcmp(&m_buffer[m_currentIndex - count], TERMINATION_BYTES, count) == 0)
+        {
+            return count;
+        }
+    }
+
+    return 0;
+}
+
+bool NextionInterfaceBase::isBufferTerminated()
+{
+    if (m_currentIndex <= NextionConstants::TERMINATION_BYTES_SIZE)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < NextionConstants::TERMINATION_BYTES_SIZE; i++)
+    {
+        if (NextionConstants::TERMINATION_BYTES[i] != m_buffer[m_currentIndex - NextionConstants::TERMINATION_BYTES_SIZE + i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool NextionInterfaceBase::processFrame(uint8_t *frame, uint16_t size)
+{
+    m_frame = frame;
+    m_frameSize = size;
+    COUNT_METRIC(countFrame(m_frame[0]));
+    return processBuffer();
+}
+
+// Decodes what receive() has queued, at most a queue's worth so that frames keep arriving meanwhile
+bool NextionInterfaceBase::processReceivedFrames()
+{
+    auto isFrameProcessed = false;
+    const auto queueSize = static_cast<uint8_t>(2 * m_receivedCapacity);
+
+    for (uint8_t i = 0; i < m_receivedCapacity && m_receivedFrames != nullptr && m_receivedHead != m_receivedTail; i++)
+    {
+        MEMORY_BARRIER();
+        const uint8_t head = m_receivedHead;
+        auto *slot = receivedFrameAt(head);
+        const auto size = static_cast<uint16_t>(slot[0] | slot[1] << 8);
+        COUNT_METRIC(rxBytes += size);
+
+        if (processFrame(&slot[FRAME_LENGTH_SIZE], size))
+        {
+            isFrameProcessed = true;
+        }
+
+        // Decoded before receive() may reuse the slot, unless clearBuffer() dropped it already
+        MEMORY_BARRIER();
+
+        if (m_receivedHead == head)
+        {
+            m_receivedHead = (head + 1) % queueSize;
+        }
+    }
+
+    return isFrameProcessed;
+}
+
+uint8_t *NextionInterfaceBase::receivedFrameAt(uint8_t position) const
+{
+    return &m_receivedFrames[static_cast<size_t>(position % m_receivedCapacity) * (m_bufferSize + FRAME_LENGTH_SIZE)];
+}
+
+bool NextionInterfaceBase::processBuffer()
+{
+    using namespace NextionConstants;
+    const auto returnCode = static_cast<ReturnCode>(m_frame[0]);
+
+    if (isAcknowledging() && matchCommandReply(returnCode))
+    {
+        return true;
+    }
+
+    const auto isError = returnCode != ReturnCode::InstructionSuccessful &&
+                         static_cast<uint8_t>(returnCode) <= static_cast<uint8_t>(ReturnCode::VariableNameTooLong);
+
+    if (isError && m_requestCount > 0 && m_requests[m_requestHead].isSent)
+    {
+        // Not the result of a tracked command, so taken for the oldest get failing on the display (e.g. an
+        // unknown attribute). Its reply will not come and the next one belongs to the request after it.
+        skipRequest();
+    }
+
+    if (returnCode == ReturnCode::SerialBufferOverflow && isPacing())
+    {
+        // Still reported as unhandled without flow control, there is nothing to recover then
+        recoverFromOverflow();
+        return true;
+    }
+
+    NextionEvent event{};
+
+    switch (returnCode)
+    {
+    case ReturnCode::TouchEvent:
+    {
+        if (payloadSize() != ExpectedPayloadSize::TOUCH_EVENT)
+        {
+            COUNT_METRIC(payloadSizeRejections++);
+            return false;
+        }
+
+        // Touches only come from the page being shown
+        setCurrentPage(m_frame[1]);
+
+        event.type = NextionEventType::Touch;
+        event.pageId = m_frame[1];
+        event.componentId = m_frame[2];
+        event.clickEvent = static_cast<ClickEvent>(m_frame[3]);
+        return emitEvent(event);
+    }
+    case ReturnCode::TouchCoordinateAwake:
+    case ReturnCode::TouchCoordinateSleep:
+    {
+        if (payloadSize() != ExpectedPayloadSize::TOUCH_COORDINATE)
+        {
+            COUNT_METRIC(payloadSizeRejections++);
+            return false;
+        }
+
+        const auto x = static_cast<uint16_t>(m_frame[1] << 8 | m_frame[2]);
+        const auto y = static_cast<uint16_t>(m_frame[3] << 8 | m_frame[4]);
+        const auto clickEvent = static_cast<ClickEvent>(m_frame[5]);
+        const auto isPressed = clickEvent == ClickEvent::Pressed;
+
+        if (isPressed && m_isTouchPressed)
+        {
+            // Still dragging, only the latest position is kept
+            m_touchX = x;
+            m_touchY = y;
+            m_isTouchMovePending = true;
+            return true;
+        }
+
+        // Report the drag before the release that ends it
+        emitTouchMove();
+        m_isTouchPressed = isPressed;
+
+        event.type = NextionEventType::TouchCoordinate;
+        event.x = x;
+        event.y = y;
+        event.clickEvent = clickEvent;
+        return emitEvent(event);
+    }
+    case ReturnCode::CurrentPageId:
+    {
+        if (payloadSize() != ExpectedPayloadSize::CURRENT_PAGE_NUMBER)
+        {
+            COUNT_METRIC(payloadSizeRejections++);
+            return false;
+        }
+
+        m_isPageIdReceived = true;
+        setCurrentPage(m_frame[1]);
+
+#if NEXTION_ENABLE_METRICS
+        if (m_isPageIdRequested)
+        {
+            m_isPageIdRequested = false;
+            NextionMetrics::recordLatency(m_metrics.sendmeLatency, millis() - m_pageIdRequestedAt);
+        }
+#endif
+
+        event.type = NextionEventType::PageId;
+        event.pageId = m_frame[1];
+        return emitEvent(event);
+    }
+    case ReturnCode::NumericDataEnclosed:
+    {
+        if (payloadSize() != ExpectedPayloadSize::NUMERIC_DATA_ENCLOSED)
+        {
+            COUNT_METRIC(payloadSizeRejections++);
+            return false;
+        }
+
+        NextionRequest request;
+
+        if (!popRequest(returnCode, request))
+        {
+            return false;
+        }
+
+        const auto numericValue = static_cast<int32_t>(static_cast<uint32_t>(m_frame[1]) |
+                                                       static_cast<uint32_t>(m_frame[2]) << 8 |
+                                                       static_cast<uint32_t>(m_frame[3]) << 16 |
+                                                       static_cast<uint32_t>(m_frame[4]) << 24);
+
+        if (request.component == nullptr)
+        {
+            setRtcField(request.rtcField, numericValue);
+            return true;
+        }
+
+        event.type = NextionEventType::NumericData;
+        event.component = request.component;
+        event.value = numericValue;
+        return emitEvent(event);
+    }
+    case ReturnCode::StringDataEnclosed:
+    {
+        NextionRequest request;
+
+        if (!popRequest(returnCode, request) || request.component == nullptr)
+        {
+            return false;
+        }
+
+        // Terminate the string in place, over the first termination byte
+        m_frame[payloadSize()] = '\0';
+        event.text = reinterpret_cast<char *>(&m_frame[1]);
+        event.type = NextionEventType::StringData;
+        event.component = request.component;
+        return emitEvent(event);
+    }
+    case ReturnCode::TransparentDataReady:
+    {
+        m_isTransparentDataReady = true;
+        return true;
+    }
+    case ReturnCode::TransparentDataFinished:
+    {
+        m_isWaveformBusy = false;
+        return true;
+    }
+    case ReturnCode::AutoEnteredSleepMode:
+    case ReturnCode::AutoWakeFromSleep:
+    {
+        const auto isSleeping = returnCode == ReturnCode::AutoEnteredSleepMode;
+
+        if (isSleeping == m_isSleeping)
+        {
+            return true;
+        }
+
+        setSleeping(isSleeping);
+        event.type = NextionEventType::SleepChanged;
+        event.value = isSleeping;
+        (void)emitEvent(event);
+        return true;
+    }
+    case ReturnCode::NextionReady:
+    {
+        // The display has restarted and lost everything written to it, the samples it was waiting for included
+        invalidateShadowCache();
+        m_isReadyReceived = true;
+        m_isTransparentDataPending = false;
+        m_isWaveformBusy = false;
+
+        // Back on page 0 before waking, so that writes held for the page it was on stay held
+        setCurrentPage(0);
+        setSleeping(false);
+
+        if (isAcknowledging())
+        {
+            // Including the return level
+            discardCommands();
+            set(Command::SetReturnLevel, static_cast<uint8_t>(ReturnLevel::Always));
+        }
+
+        // Still reported as unhandled
+        emitUnhandledReturnCode(returnCode);
+        return false;
+    }
+    default:
+    {
+        emitUnhandledReturnCode(returnCode);
+        return false;
+    }
+    }
+
+    return false;
+}
+
+uint16_t NextionInterfaceBase::payloadSize()
+{
+    return m_frameSize - NextionConstants::TERMINATION_BYTES_SIZE;
+}
+
+void NextionInterfaceBase::emitTouchMove()
+{
+    if (!m_isTouchMovePending)
+    {
+        return;
+    }
+
+    m_isTouchMovePending = false;
+
+    NextionEvent event{};
+    event.type = NextionEventType::TouchCoordinate;
+    event.x = m_touchX;
+    event.y = m_touchY;
+    event.clickEvent = NextionConstants::ClickEvent::Pressed;
+    (void)emitEvent(event);
+}
+
+void NextionInterfaceBase::emitCommandEvent(NextionEventType type, uint16_t commandId, NextionConstants::ReturnCode result)
+{
+    NextionEvent event{};
+    event.type = type;
+    event.value = commandId;
+    event.returnCode = result;
+    (void)emitEvent(event);
+}
+
+void NextionInterfaceBase::emitUnhandledReturnCode(NextionConstants::ReturnCode returnCode)
+{
+    COUNT_METRIC(unhandledReturnCodes++);
+
+    NextionEvent event{};
+    event.type = NextionEventType::ReturnCode;
+    event.returnCode = returnCode;
+    (void)emitEvent(event);
+}
+
+bool NextionInterfaceBase::emitEvent(NextionEvent &event)
+{
+    if (m_events == nullptr)
+    {
+        return deliverEvent(event);
+    }
+
+    if (event.type == NextionEventType::StringData && m_eventTexts == nullptr)
+    {
+        // No room for the string
+        m_droppedEvents++;
+        return false;
+    }
+
+    const auto queueSize = static_cast<uint8_t>(2 * m_eventCapacity);
+
+    if ((m_eventTail - m_eventHead + queueSize) % queueSize == m_eventCapacity)
+    {
+        // Full, the newest event is dropped
+        if (!m_isEventQueueFull)
+        {
+            m_eventOverflows++;
+        }
+
+        m_isEventQueueFull = true;
+        m_droppedEvents++;
+        return false;
+    }
+
+    const auto slot = static_cast<uint8_t>(m_eventTail % m_eventCapacity);
+    m_events[slot] = event;
+
+    if (event.type == NextionEventType::StringData)
+    {
+        queueEventText(slot, event.text);
+    }
+
+    // The event is complete before dispatch() can see it
+    MEMORY_BARRIER();
+    m_eventTail = (m_eventTail + 1) % queueSize;
+    m_isEventQueueFull = false;
+    return true;
+}
+
+// The receive buffer is reused by the next frame, the string is copied into the text storage of its slot
+void NextionInterfaceBase::queueEventText(uint8_t slot, const char *text)
+{
+    auto &queuedText = m_events[slot].text;
+    queuedText = &m_eventTexts[static_cast<size_t>(slot) * m_eventTextSize];
+    size_t length = strlen(text);
+
+    if (length >= m_eventTextSize)
+    {
+        length = m_eventTextSize - 1u;
+    }
+
+    memcpy(queuedText, text, length);
+    queuedText[length] = '\0';
+}
+
+bool NextionInterfaceBase::deliverEvent(NextionEvent &event)
+{
+    switch (event.type)
+    {
+    case NextionEventType::Touch:
+    {
+        const auto component = getComponent(event.pageId, event.componentId);
+
+        if (component != nullptr && component->onTouchEvent != nullptr)
+        {
+            component->onTouchEvent(event.clickEvent);
+            return true;
+        }
+
+        if (onTouchEvent == nullptr)
+        {
+            return false;
+        }
+
+        onTouchEvent(event.pageId, event.componentId, event.clickEvent);
+        return true;
+    }
+    case NextionEventType::TouchCoordinate:
+    {
+        if (onTouchCoordinate == nullptr)
+        {
+            return false;
+        }
+
+        onTouchCoordinate(event.x, event.y, event.clickEvent);
+        return true;
+    }
+    case NextionEventType::PageId:
+    {
+        if (onPageIdUpdated == nullptr)
+        {
+            return false;
+        }
+
+        onPageIdUpdated(event.pageId);
+        return true;
+    }
+    case NextionEventType::NumericData:
+    {
+        if (event.component->onNumericDataReceived != nullptr)
+        {
+            event.component->onNumericDataReceived(event.value);
+        }
+
+        if (onNumericDataReceived != nullptr)
+        {
+            onNumericDataReceived(event.component, event.value);
+        }
+
+        return true;
+    }
+    case NextionEventType::StringData:
+    {
+        if (event.component->onStringDataReceived != nullptr)
+        {
+            event.component->onStringDataReceived(event.text);
+        }
+        else if (onStringDataReceived != nullptr)
+        {
+            onStringDataReceived(event.component, event.text);
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+    case NextionEventType::DateTime:
+    {
+        if (onDateTimeReceived == nullptr)
+        {
+            return false;
+        }
+
+        onDateTimeReceived(event.dateTime);
+        return true;
+    }
+    case NextionEventType::CommandCompleted:
+    {
+        if (onCommandCompleted == nullptr)
+        {
+            return false;
+        }
+
+        onCommandCompleted(static_cast<uint16_t>(event.value));
+        return true;
+    }
+    case NextionEventType::CommandFailed:
+    {
+        if (onCommandFailed == nullptr)
+        {
+            return false;
+        }
+
+        onCommandFailed(static_cast<uint16_t>(event.value), event.returnCode);
+        return true;
+    }
+    case NextionEventType::CommandUnconfirmed:
+    {
+        if (onCommandUnconfirmed == nullptr)
+        {
+            return false;
+        }
+
+        onCommandUnconfirmed(static_cast<uint16_t>(event.value));
+        return true;
+    }
+    case NextionEventType::SleepChanged:
+    {
+        if (onSleepChanged == nullptr)
+        {
+            return false;
+        }
+
+        onSleepChanged(event.value != 0);
+        return true;
+    }
+    case NextionEventType::ReturnCode:
+    {
+        if (onUnhandledReturnCodeReceived != nullptr)
+        {
+            onUnhandledReturnCodeReceived(static_cast<uint8_t>(event.returnCode));
+        }
+
+        return false;
+    }
+    }
+
+    return false;
+}
+
+bool NextionInterfaceBase::pushRequest(const NextionComponent *component, NextionConstants::ReturnCode expectedReturnCode, NextionConstants::Command rtcField)
+{
+    if (m_requestCount >= m_maxRequests)
+    {
+        return false;
+    }
+
+    auto &request = m_requests[(m_requestHead + m_requestCount) % m_maxRequests];
+    request.component = component;
+    request.expectedReturnCode = expectedReturnCode;
+    request.rtcField = rtcField;
+    request.sentAt = millis();
+    request.isSent = false;
+    request.isExpired = false;
+    m_requestCount++;
+    return true;
+}
+
+bool NextionInterfaceBase::popRequest(NextionConstants::ReturnCode returnCode, NextionRequest &request)
+{
+    // Replies arrive in the order the requests were sent. A request whose reply type does not match
+    // has failed on the display, so it is dropped in favour of the next one.
+    while (m_requestCount > 0)
+    {
+        request = m_requests[m_requestHead];
+        m_requestHead = (m_requestHead + 1) % m_maxRequests;
+        m_requestCount--;
+
+        if (request.expectedReturnCode == returnCode)
+        {
+            if (request.isExpired)
+            {
+                // The late reply to a request already given up on
+                return false;
+            }
+
+            COUNT_METRIC(recordLatency(m_metrics.getLatency, millis() - request.sentAt));
+            return true;
+        }
+
+        dropRequest(request);
+    }
+
+    return false;
+}
+
+void NextionInterfaceBase::expireRequests()
+{
+    const auto now = millis();
+
+    for (uint8_t i = 0; i < m_requestCount; i++)
+    {
+        auto &request = m_requests[(m_requestHead + i) % m_maxRequests];
+
+        if (request.isExpired)
+        {
+            continue;
+        }
+
+        // Requests still waiting in a batch or behind flow control have no deadline yet
+        if (!request.isSent || now - request.sentAt < TIMEOUT)
+        {
+            break;
+        }
+
+        // Given up on, but its place is kept for as long again. Should the reply only be late, it is
+        // then not taken for the reply to the next request.
+        COUNT_METRIC(timeouts++);
+        dropRequest(request);
+        request.isExpired = true;
+        request.sentAt = now;
+    }
+
+    while (m_requestCount > 0 && m_requests[m_requestHead].isExpired && now - m_requests[m_requestHead].sentAt >= TIMEOUT)
+    {
+        skipRequest();
+    }
+}
+
+void NextionInterfaceBase::stampRequest()
+{
+    for (uint8_t i = 0; i < m_requestCount; i++)
+    {
+        auto &request = m_requests[(m_requestHead + i) % m_maxRequests];
+
+        if (!request.isSent)
+        {
+            request.isSent = true;
+            request.sentAt = millis();
+            return;
+        }
+    }
+}
+
+// The request of a get that was never written, always the last one queued
+void NextionInterfaceBase::cancelRequest()
+{
+    if (m_requestCount == 0)
+    {
+        return;
+    }
+
+    const auto &request = m_requests[(m_requestHead + m_requestCount - 1) % m_maxRequests];
+
+    if (!request.isSent)
+    {
+        dropRequest(request);
+        m_requestCount--;
+    }
+}
+
+void NextionInterfaceBase::skipRequest()
+{
+    dropRequest(m_requests[m_requestHead]);
+    m_requestHead = (m_requestHead + 1) % m_maxRequests;
+    m_requestCount--;
+}
+
+void NextionInterfaceBase::dropRequest(const NextionRequest &request)
+{
+    if (request.isExpired)
+    {
+        // Already accounted for when it expired
+        return;
+    }
+
+    if (request.component == nullptr && m_pendingRtcFields > 0)
+    {
+        m_isRtcRequestFailed = true;
+        m_pendingRtcFields--;
+    }
+}
+
+// Called as the frame is written
+void NextionInterfaceBase::trackFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    if (expectedReply == NextionConstants::ReturnCode::NumericDataEnclosed)
+    {
+        // Its deadline runs from now, not from when it was queued
+        stampRequest();
+    }
+
+    trackCommand(frame, length, keyLength, expectedReply);
+}
+
+void NextionInterfaceBase::trackCommand(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    using namespace NextionConstants;
+
+    if (!isAcknowledging())
+    {
+        return;
+    }
+
+    if (m_windowCount >= m_windowSize)
+    {
+        // Only its result is accounted for, so that the following ones are still matched
+        m_lastCommandId = 0;
+
+        if (expectedReply == ReturnCode::InstructionSuccessful && m_untrackedCount < UINT8_MAX)
+        {
+            m_untrackedCount++;
+        }
+
+        supersedeRetries(frame, keyLength);
+        return;
+    }
+
+    // Queries are answered with data, they cannot be retried without the request being repeated
+    const auto hasCopy = frame != nullptr && m_maxRetries > 0 && expectedReply == ReturnCode::InstructionSuccessful &&
+                         m_retryQueue.append(frame, length, keyLength);
+
+    if (!hasCopy)
+    {
+        supersedeRetries(frame, keyLength);
+    }
+
+    if (++m_nextCommandId == 0)
+    {
+        m_nextCommandId = 1;
+    }
+
+    m_lastCommandId = m_nextCommandId;
+    pushCommand(m_lastCommandId, 1, expectedReply, hasCopy, length);
+}
+
+void NextionInterfaceBase::pushCommand(uint16_t id, uint8_t attempts, NextionConstants::ReturnCode expectedReply, bool hasCopy, uint16_t length)
+{
+    auto &command = m_window[(m_windowHead + m_windowCount) % m_windowSize];
+    command.id = id;
+    command.attempts = attempts;
+    command.expectedReply = expectedReply;
+    command.hasCopy = hasCopy;
+    command.untrackedBefore = m_untrackedCount;
+    command.length = length;
+    command.sentAt = millis();
+    m_untrackedCount = 0;
+    m_windowCount++;
+}
+
+NextionPendingCommand NextionInterfaceBase::popCommand()
+{
+    const auto command = m_window[m_windowHead];
+    m_windowHead = (m_windowHead + 1) % m_windowSize;
+    m_windowCount--;
+
+    if (isPacing())
+    {
+        // Answered, expired or given up on, it has left the display's buffer either way
+        creditBytes(command.length);
+    }
+
+    return command;
+}
+
+// A newer value sent without a copy kept for it, the copies of older ones must not be sent over it
+void NextionInterfaceBase::supersedeRetries(const uint8_t *frame, uint8_t keyLength)
+{
+    if (frame != nullptr)
+    {
+        m_retryQueue.retag(frame, keyLength, SUPERSEDED_TAG);
+    }
+}
+
+void NextionInterfaceBase::releaseCommand(const NextionPendingCommand &command)
+{
+    // Copies are kept in the order the commands were sent, the oldest one is always first
+    if (command.hasCopy)
+    {
+        m_retryQueue.popFront();
+    }
+}
+
+bool NextionInterfaceBase::matchCommandReply(NextionConstants::ReturnCode returnCode)
+{
+    using namespace NextionConstants;
+
+    if (static_cast<uint8_t>(returnCode) > static_cast<uint8_t>(ReturnCode::VariableNameTooLong))
+    {
+        // Data completes the query waiting for it but is still handled as usual
+        if (m_windowCount == 0)
+        {
+            return false;
+        }
+
+        const auto expectedReply = m_window[m_windowHead].expectedReply;
+        const auto isExpected = expectedReply == ReturnCode::NumericDataEnclosed
+                                    ? returnCode == ReturnCode::NumericDataEnclosed || returnCode == ReturnCode::StringDataEnclosed
+                                    : expectedReply != ReturnCode::InstructionSuccessful && returnCode == expectedReply;
+
+        if (isExpected && m_window[m_windowHead].untrackedBefore == 0)
+        {
+            m_lastReplyAt = millis();
+            const auto command = popCommand();
+
+            emitCommandEvent(NextionEventType::CommandCompleted, command.id);
+        }
+
+        return false;
+    }
+
+    m_lastReplyAt = millis();
+
+    // Results arrive in the order the commands were sent, those of untracked commands are skipped
+    if (m_windowCount == 0)
+    {
+        if (m_untrackedCount == 0)
+        {
+            return false;
+        }
+
+        m_untrackedCount--;
+        return true;
+    }
+
+    if (m_window[m_windowHead].untrackedBefore > 0)
+    {
+        m_window[m_windowHead].untrackedBefore--;
+        return true;
+    }
+
+    const auto command = popCommand();
+
+    if (returnCode == ReturnCode::InstructionSuccessful)
+    {
+        releaseCommand(command);
+
+        emitCommandEvent(NextionEventType::CommandCompleted, command.id);
+
+        return true;
+    }
+
+    // Garbled on the way, it may get through the next time
+    const auto isTransient = returnCode == ReturnCode::InvalidInstruction || returnCode == ReturnCode::InvalidCrc;
+
+    if (isTransient && command.hasCopy && command.attempts <= m_maxRetries && resendCommand(command))
+    {
+        return true;
+    }
+
+    releaseCommand(command);
+
+    if (command.expectedReply == ReturnCode::NumericDataEnclosed && m_requestCount > 0)
+    {
+        // The get request it belongs to will not be answered
+        skipRequest();
+    }
+
+    emitCommandEvent(NextionEventType::CommandFailed, command.id, returnCode);
+
+    return true;
+}
+
+bool NextionInterfaceBase::resendCommand(const NextionPendingCommand &command)
+{
+    if (m_isTransparentDataPending)
+    {
+        // The display would take it as samples, it is reported as failed instead
+        return false;
+    }
+
+    NextionFrameQueue::Record record;
+    size_t offset = 0;
+
+    if (!m_retryQueue.next(offset, record) || record.tag == SUPERSEDED_TAG || m_retryQueue.containsKey(offset, record.frame, record.keyLength))
+    {
+        // A newer value has been written since, sending this one again would overwrite it
+        return false;
+    }
+
+    transmit(record.frame, record.length);
+
+    // Its result now comes after those of everything sent in the meantime
+    const auto hasCopy = m_retryQueue.append(record.frame, record.length, record.keyLength);
+    m_retryQueue.popFront();
+    pushCommand(command.id, command.attempts + 1, command.expectedReply, hasCopy, record.length);
+    return true;
+}
+
+void NextionInterfaceBase::expireCommands()
+{
+    const auto now = millis();
+
+    // A long window takes a while to be answered, so only give up once the display has gone quiet
+    while (m_windowCount > 0 && now - m_window[m_windowHead].sentAt >= TIMEOUT && now - m_lastReplyAt >= TIMEOUT)
+    {
+        COUNT_METRIC(timeouts++);
+        const auto command = popCommand();
+        releaseCommand(command);
+
+        emitCommandEvent(NextionEventType::CommandUnconfirmed, command.id);
+    }
+
+    if (m_windowCount == 0 && now - m_lastReplyAt >= TIMEOUT)
+    {
+        m_untrackedCount = 0;
+    }
+}
+
+void NextionInterfaceBase::discardCommands()
+{
+    m_untrackedCount = 0;
+
+    while (m_windowCount > 0)
+    {
+        const auto command = popCommand();
+        releaseCommand(command);
+
+        emitCommandEvent(NextionEventType::CommandUnconfirmed, command.id);
+    }
+}
+
+// Written at once while within the budget, otherwise held behind the frames already waiting
+void NextionInterfaceBase::paceFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    if (isPacing())
+    {
+        creditDrainedBytes();
+
+        if (!m_heldFrames.isEmpty() || !hasCredit(length))
+        {
+            if (m_heldFrames.push(frame, length, keyLength, static_cast<uint8_t>(expectedReply)))
+            {
+                return;
+            }
+
+            // No room left to hold it, what is held goes first regardless of the budget
+            releaseHeldFrames(true);
+        }
+    }
+
+    writeFrame(frame, length, keyLength, expectedReply);
+}
+
+void NextionInterfaceBase::writeFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    transmit(frame, length);
+    keepForResend(frame, length, keyLength, expectedReply);
+    trackFrame(frame, length, keyLength, expectedReply);
+}
+
+void NextionInterfaceBase::releaseHeldFrames(bool isForced)
+{
+    // While transparent data is pending the display would take them as samples
+    if (!isPacing() || m_isTransparentDataPending)
+    {
+        return;
+    }
+
+    creditDrainedBytes();
+    writeCreditedFrames(m_heldFrames, isForced);
+}
+
+// The frames at the front of the queue that the budget allows go in one write and leave the queue
+void NextionInterfaceBase::writeCreditedFrames(NextionFrameQueue &queue, bool isForced)
+{
+    NextionFrameQueue::Record record;
+    size_t end = 0;
+    uint32_t length = 0;
+
+    for (auto offset = end; queue.next(offset, record); end = offset)
+    {
+        if (!isForced && (length == 0 ? !hasCredit(record.length) : m_bytesInFlight + length + record.length > flowLimit()))
+        {
+            break;
+        }
+
+        length += record.length;
+        keepForResend(record.frame, record.length, record.keyLength, static_cast<NextionConstants::ReturnCode>(record.tag));
+        trackFrame(record.frame, record.length, record.keyLength, static_cast<NextionConstants::ReturnCode>(record.tag));
+    }
+
+    if (end == 0)
+    {
+        return;
+    }
+
+    const auto size = queue.pack(end);
+    transmit(queue.data(), size);
+    queue.popFront(end);
+}
+
+// Only latest-value writes can be sent again without repeating what they did
+void NextionInterfaceBase::keepForResend(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    if (!m_resendFrames.hasStorage() || keyLength == 0 || expectedReply != NextionConstants::ReturnCode::InstructionSuccessful)
+    {
+        return;
+    }
+
+    NextionFrameQueue::Record record;
+
+    // The oldest copies make room, their bytes are the most likely to have been taken already
+    while (!m_resendFrames.append(frame, length, keyLength))
+    {
+        size_t offset = 0;
+
+        if (!m_resendFrames.next(offset, record))
+        {
+            return;
+        }
+
+        m_resendBytes -= record.length;
+        m_resendFrames.popFront();
+    }
+
+    m_resendBytes += length;
+}
+
+void NextionInterfaceBase::creditDrainedBytes()
+{
+    const auto now = millis();
+
+    if (m_flowBackoff > 0 && now - m_backedOffAt >= FLOW_RECOVERY_TIME)
+    {
+        m_flowBackoff--;
+        m_backedOffAt = now;
+    }
+
+    if (isAcknowledging())
+    {
+        // Results credit their commands as they arrive, once all are in the buffer has been emptied
+        if (m_windowCount == 0 && m_untrackedCount == 0)
+        {
+            creditBytes(m_bytesInFlight);
+        }
+
+        return;
+    }
+
+    if (m_bytesInFlight == 0)
+    {
+        return;
+    }
+
+    const auto drainRate = (m_drainRate >> m_flowBackoff) > 0 ? m_drainRate >> m_flowBackoff : 1;
+    const auto elapsed = now - m_drainedAt;
+
+    if (elapsed >= m_bytesInFlight * 1000UL / drainRate)
+    {
+        creditBytes(m_bytesInFlight);
+        return;
+    }
+
+    const auto drained = static_cast<uint32_t>(elapsed * drainRate / 1000);
+
+    if (drained > 0)
+    {
+        creditBytes(drained);
+
+        // The time rounded off is carried over
+        m_drainedAt += drained * 1000UL / drainRate;
+    }
+}
+
+void NextionInterfaceBase::creditBytes(uint32_t size)
+{
+    m_bytesInFlight = size < m_bytesInFlight ? m_bytesInFlight - size : 0;
+
+    // Copies are kept in the order the frames were sent, so the oldest ones are those of the bytes taken
+    NextionFrameQueue::Record record;
+
+    for (size_t offset = 0; m_resendBytes > m_bytesInFlight && m_resendFrames.next(offset, record); offset = 0)
+    {
+        m_resendBytes -= record.length;
+        m_resendFrames.popFront();
+    }
+}
+
+bool NextionInterfaceBase::hasCredit(uint16_t length) const
+{
+    // A frame longer than the budget still goes, alone
+    return m_bytesInFlight == 0 || m_bytesInFlight + length <= flowLimit();
+}
+
+uint32_t NextionInterfaceBase::flowLimit() const
+{
+    return m_flowBudget >> m_flowBackoff;
+}
+
+void NextionInterfaceBase::recoverFromOverflow()
+{
+    using namespace NextionConstants;
+
+    const auto now = millis();
+
+    if (m_flowBackoff < MAX_FLOW_BACKOFF)
+    {
+        m_flowBackoff++;
+    }
+
+    m_backedOffAt = now;
+
+    // The display's buffer is full, nothing more goes until it has drained at the slower pace
+    if (m_bytesInFlight < flowLimit())
+    {
+        m_bytesInFlight = flowLimit();
+    }
+
+    m_drainedAt = now;
+
+    // Which commands were dropped is not reported, so every write that may have been is sent again
+    NextionFrameQueue::Record record;
+
+    for (size_t offset = 0; m_resendFrames.next(offset, record);)
+    {
+        // Unless a newer value has been written since, or is still held
+        if (m_resendFrames.containsKey(offset, record.frame, record.keyLength) || m_heldFrames.containsKey(0, record.frame, record.keyLength))
+        {
+            continue;
+        }
+
+        if (m_heldFrames.push(record.frame, record.length, record.keyLength, static_cast<uint8_t>(ReturnCode::InstructionSuccessful)))
+        {
+            COUNT_METRIC(resentFrames++);
+        }
+        else
+        {
+            COUNT_METRIC(droppedFrames++);
+        }
+    }
+
+    m_resendFrames.clear();
+    m_resendBytes = 0;
+}
+
+void NextionInterfaceBase::switchHostBaudRate(uint32_t baudRate)
+{
+    // Let the command leave at the old rate before the port changes
+    m_stream->flush();
+    onBaudRateChange(baudRate);
+    delay(BAUD_RATE_SETTLE_TIME);
+
+    // Anything received meanwhile is garbage
+    clearBuffer();
+}
+
+bool NextionInterfaceBase::beginTransparentData(const NextionComponent &waveform, uint8_t channel, uint16_t count)
+{
+    using namespace NextionConstants;
+
+    if (m_isWaveformBusy || count == 0 || count > MAX_TRANSPARENT_DATA_SIZE)
+    {
+        return false;
+    }
+
+    auto frame = beginFrame();
+    writeCommand(frame, Command::AddTransparentData);
+    sendParameterList(frame, waveform.id(), channel, count);
+    frame.expectReply(ReturnCode::TransparentDataReady);
+
+    if (!sendFrame(frame))
+    {
+        return false;
+    }
+
+    // Anything queued goes first, after that nothing else may be sent until the display is ready. Held
+    // back by flow control, addt would only go out later with no samples behind it.
+    flush();
+    releaseHeldFrames(true);
+    m_isWaveformBusy = true;
+    m_isTransparentDataReady = false;
+    m_isTransparentDataPending = true;
+    m_waveformStartedAt = millis();
+    m_waveformBlockSize = count;
+
+    while (m_isTransparentDataPending && !m_isTransparentDataReady && millis() - m_waveformStartedAt < TIMEOUT)
+    {
+        update();
+    }
+
+    m_isTransparentDataPending = false;
+    return m_isTransparentDataReady;
+}
+
+void NextionInterfaceBase::streamWaveformChannels()
+{
+    if (m_waveformChannels == nullptr)
+    {
+        return;
+    }
+
+    // In turn, so that a channel filling up quickly cannot starve the others
+    const auto first = m_nextWaveformChannel;
+    auto next = first;
+
+    do
+    {
+        const auto channel = next != nullptr ? next : m_waveformChannels;
+        next = channel->m_next;
+
+        if (channel->size() == 0)
+        {
+            continue;
+        }
+
+        m_nextWaveformChannel = next;
+        const auto count = channel->size() < NextionConstants::MAX_TRANSPARENT_DATA_SIZE ? channel->size() : NextionConstants::MAX_TRANSPARENT_DATA_SIZE;
+
+        if (!beginTransparentData(*channel->m_waveform, channel->m_channel, count))
+        {
+            return;
+        }
+
+        // The samples may wrap around the end of the buffer
+        for (auto remaining = count; remaining > 0;)
+        {
+            const auto part = channel->contiguousSize() < remaining ? channel->contiguousSize() : remaining;
+            transmit(&channel->m_buffer[channel->m_head], part);
+            channel->consume(part);
+            remaining -= part;
+        }
+
+        return;
+    } while (next != first);
+}
+
+bool NextionInterfaceBase::requestRtcFields(const NextionConstants::Command *fields, uint8_t count)
+{
+    if (m_pendingRtcFields > 0 || m_maxRequests - m_requestCount < count)
+    {
+        return false;
+    }
+
+    m_isRtcRequestFailed = false;
+
+    for (auto i = 0; i < count; i++)
+    {
+        // Cannot fail, the free space has been checked above
+        (void)pushRequest(nullptr, NextionConstants::ReturnCode::NumericDataEnclosed, fields[i]);
+        m_pendingRtcFields++;
+        get(fields[i]);
+    }
+
+    return true;
+}
+
+void NextionInterfaceBase::setRtcField(NextionConstants::Command field, int32_t value)
+{
+    using namespace NextionConstants;
+
+    switch (field)
     {
-        return "sleep";
-    }
     case Command::RtcYear:
     {
-        return "rtc0";
+        m_dateTime.year = static_cast<uint16_t>(value);
+        break;
     }
     case Command::RtcMonth:
     {
-        return "rtc1";
+        m_dateTime.month = static_cast<uint8_t>(value);
+        break;
     }
     case Command::RtcDay:
     {
-        return "rtc2";
+        m_dateTime.day = static_cast<uint8_t>(value);
+        break;
     }
     case Command::RtcHour:
     {
-        return "rtc3";
+        m_dateTime.hour = static_cast<uint8_t>(value);
+        break;
     }
     case Command::RtcMinute:
     {
-        return "rtc4";
+        m_dateTime.minute = static_cast<uint8_t>(value);
+        break;
     }
     case Command::RtcSecond:
     {
-        return "rtc5";
+        m_dateTime.second = static_cast<uint8_t>(value);
+        break;
     }
     case Command::RtcDayOfTheWeek:
     {
-        return "rtc6";
+        m_dateTime.dayOfTheWeek = static_cast<uint8_t>(value);
+        break;
+    }
+    default:
+    {
+        break;
+    }
+    }
+
+    if (m_pendingRtcFields == 0 || --m_pendingRtcFields > 0)
+    {
+        return;
+    }
+
+    if (m_isRtcRequestFailed)
+    {
+        return;
+    }
+
+    NextionEvent event{};
+    event.type = NextionEventType::DateTime;
+    event.dateTime = m_dateTime;
+    (void)emitEvent(event);
+}
+
+NextionShadowEntry *NextionInterfaceBase::findShadowEntry(const NextionComponent &component) const
+{
+    for (auto entry = m_shadowEntries; entry != nullptr; entry = entry->m_next)
+    {
+        if (entry->m_component == &component)
+        {
+            return entry;
+        }
     }
+
+    return nullptr;
+}
+
+NextionRateLimit *NextionInterfaceBase::findRateLimit(const NextionComponent &component) const
+{
+    for (auto limit = m_rateLimits; limit != nullptr; limit = limit->m_next)
+    {
+        if (limit->m_component == &component)
+        {
+            return limit;
+        }
     }
 
-    // static_assert(false, "Failed to retrieve command. Unhandled command.");
     return nullptr;
 }
 
-void NextionInterface::sendCommand(const NextionConstants::Command &command)
+bool NextionInterfaceBase::isRateLimited(const NextionComponent &component, int32_t value)
+{
+    const auto limit = findRateLimit(component);
+
+    if (limit == nullptr)
+    {
+        return false;
+    }
+
+    if (limit->m_hasSentValue)
+    {
+        const auto difference = value > limit->m_sentValue
+                                    ? static_cast<uint32_t>(value) - static_cast<uint32_t>(limit->m_sentValue)
+                                    : static_cast<uint32_t>(limit->m_sentValue) - static_cast<uint32_t>(value);
+
+        if (difference < limit->m_deadband)
+        {
+            // Close enough to what is shown, an older held value would only move it away
+            limit->m_hasPendingValue = false;
+            return true;
+        }
+
+        if (millis() - limit->m_sentAt < limit->m_minInterval)
+        {
+            limit->m_pendingValue = value;
+            limit->m_hasPendingValue = true;
+            return true;
+        }
+    }
+
+    limit->m_sentAt = millis();
+    limit->m_sentValue = value;
+    limit->m_hasSentValue = true;
+    limit->m_hasPendingValue = false;
+    return false;
+}
+
+void NextionInterfaceBase::releaseRateLimitedValues()
+{
+    // Kept pending until the display takes commands again
+    if (m_isTransparentDataPending)
+    {
+        return;
+    }
+
+    for (auto limit = m_rateLimits; limit != nullptr; limit = limit->m_next)
+    {
+        if (!limit->m_hasPendingValue || millis() - limit->m_sentAt < limit->m_minInterval)
+        {
+            continue;
+        }
+
+        limit->m_sentAt = millis();
+        limit->m_sentValue = limit->m_pendingValue;
+        limit->m_hasSentValue = true;
+        limit->m_hasPendingValue = false;
+        writeAttribute(*limit->m_component, NextionConstants::Attribute::Value, limit->m_pendingValue);
+    }
+}
+
+void NextionInterfaceBase::writeAttribute(const NextionComponent &component, NextionConstants::Attribute attribute, int32_t value, const char *prefix, uint8_t prefixLength)
+{
+    const auto shadowEntry = findShadowEntry(component);
+
+    if (shadowEntry != nullptr && shadowEntry->isCached(attribute, static_cast<uint32_t>(value)))
+    {
+        return;
+    }
+
+    auto frame = beginFrame();
+    appendPrefix(frame, component, attribute, prefix, prefixLength);
+    const auto keyLength = frame.size();
+    frame.appendInteger(value);
+
+    if (sendFrame(frame, keyLength, &component) && shadowEntry != nullptr)
+    {
+        shadowEntry->store(attribute, static_cast<uint32_t>(value));
+    }
+}
+
+bool NextionInterfaceBase::writeText(const NextionComponent &component, const char *value, const char *prefix, uint8_t prefixLength)
+{
+    const auto shadowEntry = findShadowEntry(component);
+    const auto hash = shadowEntry != nullptr ? Utils::hash(value) : 0;
+
+    if (shadowEntry != nullptr && shadowEntry->isCached(NextionConstants::Attribute::Text, hash))
+    {
+        return true;
+    }
+
+    auto frame = beginFrame();
+    appendPrefix(frame, component, NextionConstants::Attribute::Text, prefix, prefixLength);
+    const auto keyLength = frame.size();
+    frame.append('"');
+    const auto valueLength = strlen(value);
+    auto isSent = false;
+
+    if (!frame.fits(valueLength + 1))
+    {
+        frame.makeRoom();
+    }
+
+    if (frame.fits(valueLength + 1) || !frame.isValid())
+    {
+        frame.append(value, valueLength);
+        frame.append('"');
+        isSent = sendFrame(frame, keyLength, &component);
+    }
+    else if (isDeferred(component.pageId()))
+    {
+        // Too long to be held for its page
+        dropFrame(frame.expectedReply());
+    }
+    else if (beginStreamedFrame())
+    {
+        // Too long for the transmit buffer, the prefix and quote built so far are followed by the rest
+        transmit(frame.data(), frame.size());
+        transmit(reinterpret_cast<const uint8_t *>(value), valueLength);
+        transmit(reinterpret_cast<const uint8_t *>("\""), 1);
+        supersedeRetries(frame.data(), keyLength <= UINT8_MAX ? static_cast<uint8_t>(keyLength) : 0);
+        endStreamedFrame();
+        isSent = true;
+    }
+
+    if (isSent && shadowEntry != nullptr)
+    {
+        shadowEntry->store(NextionConstants::Attribute::Text, hash);
+    }
+
+    return isSent;
+}
+
+// "<name><suffix>=", copied when the component has it formatted already
+void NextionInterfaceBase::appendPrefix(NextionFrameBuilder &frame, const NextionComponent &component, NextionConstants::Attribute attribute, const char *prefix, uint8_t prefixLength)
+{
+    if (prefixLength > 0)
+    {
+        frame.append(prefix, prefixLength);
+        return;
+    }
+
+    appendParameter(frame, component);
+    appendAttribute(frame, attribute);
+    frame.append(NextionConstants::ASSIGNMENT_CHARACTER);
+}
+
+NextionFrameBuilder NextionInterfaceBase::beginFrame()
+{
+    // Built behind the staged frames, so that it can be sent along with them
+    if (m_stagedSize > 0)
+    {
+        return NextionFrameBuilder(m_txBuffer + m_stagedSize, m_txBufferSize - m_stagedSize, unstageFrame, this);
+    }
+
+    return NextionFrameBuilder(m_txBuffer, m_txBufferSize);
+}
+
+void NextionInterfaceBase::beginStaging()
+{
+    m_isStaging = true;
+}
+
+void NextionInterfaceBase::endStaging()
+{
+    transmitStaged();
+    m_isStaging = false;
+
+    if (isBatching())
+    {
+        flush();
+    }
+}
+
+void NextionInterfaceBase::transmitStaged()
+{
+    if (m_stagedSize == 0)
+    {
+        return;
+    }
+
+    transmit(m_txBuffer, m_stagedSize);
+    m_stagedSize = 0;
+}
+
+// A frame that outgrows the room behind the staged ones is continued at the start of the buffer, once
+// they have been sent
+uint8_t *NextionInterfaceBase::unstageFrame(void *owner, const uint8_t *frame, size_t size)
+{
+    auto &self = *static_cast<NextionInterfaceBase *>(owner);
+
+    if (frame != self.m_txBuffer + self.m_stagedSize)
+    {
+        return nullptr;
+    }
+
+    self.transmitStaged();
+    memmove(self.m_txBuffer, frame, size);
+    return self.m_txBuffer;
+}
+
+bool NextionInterfaceBase::sendFrame(NextionFrameBuilder &frame, size_t keyLength, const NextionComponent *target)
+{
+    frame.terminate();
+
+    if (!frame.isValid())
+    {
+        dropFrame(frame.expectedReply());
+        return false;
+    }
+
+    const auto length = static_cast<uint16_t>(frame.size());
+    const auto key = keyLength <= UINT8_MAX ? static_cast<uint8_t>(keyLength) : 0;
+
+    if (target != nullptr && isDeferred(target->pageId()) && m_deferredWrites.push(frame.data(), length, key, target->pageId()))
+    {
+        // Not shown, only the latest value is kept until its page is
+        return true;
+    }
+
+    return submitFrame(frame.data(), length, key, frame.expectedReply());
+}
+
+void NextionInterfaceBase::dropFrame(NextionConstants::ReturnCode expectedReply)
+{
+    COUNT_METRIC(droppedFrames++);
+
+    if (expectedReply == NextionConstants::ReturnCode::NumericDataEnclosed)
+    {
+        // The get will not be answered
+        cancelRequest();
+    }
+}
+
+// Frames too long for the transmit buffer are written in parts, after everything queued before them.
+// They cannot be batched, held or kept for a retry.
+bool NextionInterfaceBase::beginStreamedFrame()
+{
+    if (m_isTransparentDataPending)
+    {
+        dropFrame(NextionConstants::ReturnCode::InstructionSuccessful);
+        return false;
+    }
+
+    flush();
+    transmitStaged();
+    releaseHeldFrames(true);
+    return true;
+}
+
+void NextionInterfaceBase::endStreamedFrame()
+{
+    transmit(NextionConstants::TERMINATION_BYTES, NextionConstants::TERMINATION_BYTES_SIZE);
+    trackFrame(nullptr, 0, 0, NextionConstants::ReturnCode::InstructionSuccessful);
+}
+
+bool NextionInterfaceBase::submitFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply)
+{
+    const auto tag = static_cast<uint8_t>(expectedReply);
+
+    if (m_isTransparentDataPending)
+    {
+        // The display would take it as samples, it can only wait in the batch
+        if (isBatching() && m_txQueue.push(frame, length, keyLength, tag))
+        {
+            return true;
+        }
+
+        dropFrame(expectedReply);
+        return false;
+    }
+
+    if (!isBatching())
+    {
+        // Flow control goes frame by frame, staged frames would all be written at once
+        if (m_isStaging && !isPacing() && frame == m_txBuffer + m_stagedSize)
+        {
+            // Left in place, written with the frames staged before it
+            m_stagedSize += length;
+            trackFrame(frame, length, keyLength, expectedReply);
+        }
+        else
+        {
+            transmitStaged();
+            paceFrame(frame, length, keyLength, expectedReply);
+        }
+
+        return true;
+    }
+
+    if (m_txQueue.isEmpty())
+    {
+        m_batchStartedAt = millis();
+    }
+
+    if (m_txQueue.push(frame, length, keyLength, tag))
+    {
+        return true;
+    }
+
+    // No room left, send what is queued and start a new batch
+    flush();
+    m_batchStartedAt = millis();
+
+    if (!m_txQueue.push(frame, length, keyLength, tag))
+    {
+        paceFrame(frame, length, keyLength, expectedReply);
+    }
+
+    return true;
+}
+
+bool NextionInterfaceBase::isDeferred(uint8_t pageId) const
+{
+    return m_deferredWrites.hasStorage() && (m_isSleeping || (m_isCurrentPageKnown && pageId != m_currentPageId));
+}
+
+void NextionInterfaceBase::setCurrentPage(uint8_t pageId)
+{
+    if (m_isCurrentPageKnown && pageId == m_currentPageId)
+    {
+        return;
+    }
+
+    m_currentPageId = pageId;
+    m_isCurrentPageKnown = true;
+
+    // However it was changed, the components of the page start again from their designer values
+    invalidateShadowCache(pageId);
+    releaseDeferredWrites();
+}
+
+void NextionInterfaceBase::setSleeping(bool isSleeping)
+{
+    m_isSleeping = isSleeping;
+    releaseDeferredWrites();
+}
+
+// Sends the held writes that are no longer deferred
+void NextionInterfaceBase::releaseDeferredWrites()
+{
+    if (!m_deferredWrites.hasStorage() || m_isSleeping)
+    {
+        return;
+    }
+
+    if (m_isTransparentDataPending)
+    {
+        // Left to the next update()
+        m_isDeferredReleasePending = true;
+        return;
+    }
+
+    m_isDeferredReleasePending = false;
+
+    NextionFrameQueue::Record record;
+    auto isReleased = false;
+
+    for (size_t offset = 0; m_deferredWrites.next(offset, record);)
+    {
+        if (!isDeferred(record.tag))
+        {
+            submitFrame(record.frame, record.length, record.keyLength, NextionConstants::ReturnCode::InstructionSuccessful);
+            isReleased = true;
+        }
+    }
+
+    if (!isReleased)
+    {
+        return;
+    }
+
+    if (m_isCurrentPageKnown)
+    {
+        m_deferredWrites.remove(m_currentPageId);
+    }
+    else
+    {
+        m_deferredWrites.clear();
+    }
+
+    // In one burst when batching
+    flush();
+}
+
+void NextionInterfaceBase::trackPageChange(const char *)
+{
+    // Only known once the display tells
+    m_isCurrentPageKnown = false;
+
+    if (m_deferredWrites.hasStorage())
+    {
+        getCurrentPageId();
+    }
+}
+
+void NextionInterfaceBase::trackPageChange(char *page)
 {
-    m_stream->print(getCommand(command));
-    writeTerminationBytes();
+    trackPageChange(static_cast<const char *>(page));
 }
 
-void NextionInterface::sendCommand(const NextionConstants::Command &command, const NextionComponent &component)
+void NextionInterfaceBase::trackPageChange(const __FlashStringHelper *page)
 {
-    sendCommand(command, component.name());
+    trackPageChange(reinterpret_cast<const char *>(page));
+}
+
+void NextionInterfaceBase::transmit(const uint8_t *data, size_t size)
+{
+    if (isPacing())
+    {
+        if (m_bytesInFlight == 0)
+        {
+            m_drainedAt = millis();
+        }
+
+        m_bytesInFlight += size;
+    }
+
+    m_stream->write(data, size);
+    COUNT_METRIC(txBytes += size);
 }
 
-template <>
-void NextionInterface::sendCommand<NextionConstants::Command>(const NextionConstants::Command &command, const NextionConstants::Command &payload)
+void NextionInterfaceBase::writeCommand(NextionFrameBuilder &frame, const NextionConstants::Command &command)
 {
-    writeCommand(command);
-    m_stream->print(getCommand(payload));
-    writeTerminationBytes();
+    appendParameter(frame, command);
+    frame.append(NextionConstants::COMMAND_SEPARATOR);
+
+    if (command == NextionConstants::Command::Get)
+    {
+        // String data is accepted as well
+        frame.expectReply(NextionConstants::ReturnCode::NumericDataEnclosed);
+    }
 }
 
-void NextionInterface::sendParameterList(const NextionComponent &component)
+void NextionInterfaceBase::sendCommand(const NextionConstants::Command &command)
 {
-    sendParameterList(component.name());
+    auto frame = beginFrame();
+    appendParameter(frame, command);
+
+    if (command == NextionConstants::Command::GetPageId)
+    {
+        frame.expectReply(NextionConstants::ReturnCode::CurrentPageId);
+    }
+
+    sendFrame(frame);
 }
 
-void NextionInterface::setText(const char *objectName, const char *value)
+void NextionInterfaceBase::appendParameter(NextionFrameBuilder &frame, const char *value)
 {
-    char result[strlen(objectName) + strlen(NextionConstants::TEXT_ATTRIBUTE) + strlen(value) + 4];
-    sprintf(result, "%s%s=\"%s\"", objectName, NextionConstants::TEXT_ATTRIBUTE, value);
-    sendRaw(result);
+    frame.append(value);
 }
 
-void NextionInterface::setInteger(const char *objectName, int value)
+void NextionInterfaceBase::appendParameter(NextionFrameBuilder &frame, char *value)
 {
-    char result[strlen(objectName) + strlen(NextionConstants::NUMERIC_ATTRIBUTE) + digits(value) + 2];
-    sprintf(result, "%s%s=%d", objectName, NextionConstants::NUMERIC_ATTRIBUTE, value);
-    sendRaw(result);
+    frame.append(value);
 }
 
-void NextionInterface::getText(const char *objectName)
+void NextionInterfaceBase::appendParameter(NextionFrameBuilder &frame, const __FlashStringHelper *value)
 {
-    char tmp[strlen(objectName) + strlen(NextionConstants::TEXT_ATTRIBUTE) + 1];
-    sprintf(tmp, "%s%s", objectName, NextionConstants::TEXT_ATTRIBUTE);
-    get(tmp);
+    frame.appendFlash(reinterpret_cast<const char *>(value));
 }
 
-void NextionInterface::getInteger(const char *objectName)
+void NextionInterfaceBase::appendParameter(NextionFrameBuilder &frame, const NextionComponent &component)
 {
-    char tmp[strlen(objectName) + strlen(NextionConstants::NUMERIC_ATTRIBUTE) + 1];
-    sprintf(tmp, "%s%s", objectName, NextionConstants::NUMERIC_ATTRIBUTE);
-    get(tmp);
+    if (component.isNameInFlash())
+    {
+        frame.appendFlash(component.name());
+        return;
+    }
+
+    frame.append(component.name());
 }
 
-void NextionInterface::convert(const char *source, const char *destination, const uint8_t length, NextionConstants::ConversionFormat format)
+void NextionInterfaceBase::appendParameter(NextionFrameBuilder &frame, NextionConstants::Command command)
 {
-    writeCommand(NextionConstants::Command::Convert);
-    sendParameterList(source, destination, length, static_cast<uint8_t>(format));
-    writeTerminationBytes();
+    frame.appendFlash(NextionConstants::COMMAND_NAMES[static_cast<uint16_t>(command)].name);
 }
 
-void NextionInterface::setColor(const char *objectName, const char *attribute, const uint16_t color)
+void NextionInterfaceBase::appendAttribute(NextionFrameBuilder &frame, NextionConstants::Attribute attribute)
 {
-    char result[strlen(objectName) + strlen(attribute) + digits(color) + 4];
-    sprintf(result, "%s%s=%d", objectName, attribute, color);
-    sendRaw(result);
+    frame.appendFlash(NextionConstants::ATTRIBUTE_SUFFIXES[static_cast<uint8_t>(attribute)].suffix);
 }
+
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "Arduino.h"
+#include "NextionComponent.h"
+#include "NextionComponentRegistry.h"
+#include "NextionConfig.h"
 #include "NextionConstants.h"
-
-#include <LinkedList.h>
-
-using ComponentId = uint8_t;
+#include "NextionFrameBuilder.h"
+#include "NextionFrameQueue.h"
+#include "NextionMetrics.h"
+#include "NextionRateLimit.h"
+#include "NextionShadowEntry.h"
+#include "NextionWaveformChannel.h"
 
 struct DateTime
 {
@@ -18,70 +23,240 @@ struct DateTime
     uint8_t dayOfTheWeek{};
 };
 
-class NextionComponent
+struct NextionRequest
 {
-public:
-    explicit NextionComponent(uint8_t pageId, ComponentId id, const char *name)
-        : m_pageId(pageId), m_id(id)
-    {
-        m_name = new char[strlen(name) + 1];
-        strcpy(m_name, name);
-    }
-
-    ~NextionComponent()
-    {
-        delete[] m_name;
-    }
+    const NextionComponent *component;
+    NextionConstants::ReturnCode expectedReturnCode;
+    NextionConstants::Command rtcField;
+    unsigned long sentAt;
+    bool isSent;
+    bool isExpired;
+};
 
-    [[nodiscard]] uint8_t pageId() const
-    {
-        return m_pageId;
-    }
+struct NextionPendingCommand
+{
+    uint16_t id;
+    uint8_t attempts;
+    NextionConstants::ReturnCode expectedReply;
+    bool hasCopy;
+    uint8_t untrackedBefore;
+    uint16_t length;
+    unsigned long sentAt;
+};
 
-    [[nodiscard]] ComponentId id() const
-    {
-        return m_id;
-    }
+struct NextionStartupOptions
+{
+    // Rate the host port is opened at, stepped up to maxBaudRate when that is higher
+    uint32_t baudRate = 9600;
+    uint32_t maxBaudRate = 0;
+    NextionConstants::ReturnLevel returnLevel = NextionConstants::ReturnLevel::OnFailure;
+    bool isTouchCoordinateReported = false;
+    bool isWokenByTouch = true;
+    uint16_t readyTimeout = 2000;
+};
 
-    [[nodiscard]] char *name() const
-    {
-        return m_name;
-    }
+// Times in ms since begin() was called
+struct NextionStartupReport
+{
+    bool isReady;
+    uint32_t baudRate;
+    unsigned long timeToReady;
+    // Until the display has taken the whole initial state, 0 without one or when it was not confirmed
+    unsigned long timeToFirstFrame;
+};
 
-    void (*onTouchEvent)(NextionConstants::ClickEvent event);
-    void (*onNumericDataReceived)(int32_t data);
-    void (*onStringDataReceived)(char *data);
+enum class NextionEventType : uint8_t
+{
+    Touch,
+    TouchCoordinate,
+    PageId,
+    NumericData,
+    StringData,
+    DateTime,
+    CommandCompleted,
+    CommandFailed,
+    CommandUnconfirmed,
+    SleepChanged,
+    ReturnCode
+};
 
-private:
-    uint8_t m_pageId;
-    ComponentId m_id;
-    char *m_name;
+// A decoded frame waiting to be handed to its callback, only the fields of its type are set
+struct NextionEvent
+{
+    NextionEventType type;
+    const NextionComponent *component;
+    uint8_t pageId;
+    ComponentId componentId;
+    NextionConstants::ClickEvent clickEvent;
+    uint16_t x;
+    uint16_t y;
+    int32_t value;
+    NextionConstants::ReturnCode returnCode;
+    DateTime dateTime;
+
+    // Valid until the callback returns: in the receive buffer, or in the text storage of the queue
+    char *text;
 };
 
-class NextionInterface
+template <NextionConstants::Attribute MainAttribute>
+class NextionTypedComponent;
+
+class NextionInterfaceBase
 {
 public:
-    explicit NextionInterface(Stream &stream);
-    ~NextionInterface();
+    // The buffers are owned by the caller and must outlive the interface, see BasicNextionInterface.
+    // Without room for components the registry grows on the heap.
+    NextionInterfaceBase(Stream &stream, uint8_t *rxBuffer, uint16_t rxBufferSize, uint8_t *txBuffer, uint16_t txBufferSize, NextionRequest *requests, uint8_t maxRequests,
+                         const NextionComponent **components = nullptr, size_t maxComponents = 0);
+
+    NextionInterfaceBase(const NextionInterfaceBase &) = delete;
+    NextionInterfaceBase &operator=(const NextionInterfaceBase &) = delete;
 
-    void registerComponent(NextionComponent &component);
-    [[nodiscard]] NextionComponent *getComponent(uint8_t pageId, ComponentId componentId);
+    void registerComponent(const NextionComponent &component);
+    [[nodiscard]] const NextionComponent *getComponent(uint8_t pageId, ComponentId componentId);
 
     void clearBuffer();
     bool update();
+
+    // Reading moves to receive(), which only frames what the display sends into frames, size bytes with
+    // room for size / (RxBytes + 2) frames. It never writes nor calls back, so it may run from an
+    // interrupt or a task of its own. update() then no longer reads the stream but decodes the queued
+    // frames, and must run in the same context as everything that sends, since decoding may write to the
+    // display (deferred writes, retries, the setup after a restart). Blocking calls such as begin() rely
+    // on receive() running meanwhile. Enable it before receive() is first called, and stop calling it
+    // before disabling.
+    void enableReceiveQueue(uint8_t *frames, size_t size);
+    void disableReceiveQueue();
+    uint8_t receive();
+    [[nodiscard]] uint32_t droppedReceivedFrameCount() const;
+
+    // Callbacks are no longer called by update() but queued, up to capacity events, until dispatch()
+    // is called, e.g. a few at a time so that a slow callback does not hold up reading. Strings are
+    // copied into texts, textSize bytes per event, and cut when longer. RxBytes of BasicNextionInterface
+    // fits any. Without texts string data is dropped, and counted by droppedEventCount().
+    void enableEventQueue(NextionEvent *events, uint8_t capacity, char *texts, uint16_t textSize);
+    void disableEventQueue();
+    uint8_t dispatch(uint8_t maxEvents = UINT8_MAX);
+    [[nodiscard]] uint8_t pendingEventCount() const;
+    [[nodiscard]] uint32_t droppedEventCount() const;
+    [[nodiscard]] uint32_t eventOverflowCount() const;
+
+    // Writes to components on a page other than the current one are held in buffer, latest value only,
+    // and sent when their page is shown. The current page is learnt from changePage(), sendme replies and
+    // touch events, nothing is held while it is unknown. Pages the display changes to on its own are
+    // learnt sooner with sendme in their Preinitialize event.
+    void enableDeferredWrites(uint8_t *buffer, size_t size);
+    void disableDeferredWrites();
+    [[nodiscard]] bool isCurrentPageKnown() const;
+    [[nodiscard]] uint8_t currentPageId() const;
+
+    void enableBatching(uint8_t *buffer, size_t size, uint16_t flushDelay = 0);
+    void disableBatching();
+    [[nodiscard]] bool isBatching() const;
+    void flush();
+
+    // Sets bkcmd=3 and tracks every command sent from now on in a window of windowSize commands, in
+    // the order their results are reported. Commands are kept in retryBuffer, when given, so that
+    // those rejected as garbled can be sent again up to maxRetries times. Commands sent while the
+    // window is full are not tracked and lastCommandId() returns 0 for them.
+    void enableAcknowledgements(NextionPendingCommand *window, uint8_t windowSize, uint8_t *retryBuffer = nullptr, size_t retryBufferSize = 0, uint8_t maxRetries = 1);
+    void disableAcknowledgements();
+    [[nodiscard]] bool isAcknowledging() const;
+    [[nodiscard]] uint16_t lastCommandId() const;
+    [[nodiscard]] uint8_t unacknowledgedCount() const;
+
+    // Paces commands so that at most budget bytes wait in the display's serial buffer, past which it
+    // drops them and replies with SerialBufferOverflow. Sent bytes are credited back as their results
+    // arrive when acknowledging, otherwise as the display is assumed to take drainRate bytes per second.
+    // Commands over the budget are held in holdBuffer, latest value only, and sent by update(). Writes
+    // that may still be in the display's buffer are kept in resendBuffer, when given, and written again
+    // after an overflow. The budget and drain rate are then halved for a while.
+    void enableFlowControl(uint8_t *holdBuffer, size_t holdBufferSize, uint8_t *resendBuffer = nullptr, size_t resendBufferSize = 0,
+                           uint16_t budget = NextionConstants::SERIAL_BUFFER_SIZE, uint32_t drainRate = NextionConstants::DEFAULT_DRAIN_RATE);
+    void disableFlowControl();
+    [[nodiscard]] bool isPacing() const;
+    [[nodiscard]] uint32_t bytesInFlight() const;
+
+#if NEXTION_ENABLE_METRICS
+    [[nodiscard]] NextionMetrics metrics() const;
+    void resetMetrics();
+#endif
+
     void reset();
     void sendRaw(const char *raw);
 
-    void setText(const NextionComponent &component, const char *value);
+    // Round trip with sendme, true once the display has answered
+    bool probe();
+
+    // Waits for the display to report it is ready (0x88), probing with sendme in case it already is,
+    // instead of a fixed delay. Then sets the link up as given and sends the state from onInitialState
+    // in a single write, as much of it as the transmit buffer (or the batch, when batching) holds, and
+    // frame by frame when pacing. Call it before enabling acknowledgements.
+    NextionStartupReport begin(const NextionStartupOptions &options = NextionStartupOptions());
+
+    // Moves the link to baudRate and confirms it with a probe, going back to currentBaudRate when the
+    // display cannot be reached at the new rate. The host port is switched through onBaudRateChange.
+    bool changeBaudRate(uint32_t currentBaudRate, uint32_t baudRate);
+
+    // Steps up through the supported rates, fastest first, and returns the one in use
+    uint32_t negotiateBaudRate(uint32_t currentBaudRate, uint32_t maxBaudRate = NextionConstants::MAX_BAUD_RATE);
+
+    // Kept by the display across power cycles (bauds=), only use a rate that has been confirmed
+    void saveBaudRate(uint32_t baudRate);
+
+    // Writes of the value the display already shows are skipped. The entries of a page are invalidated
+    // whenever it is shown, be it through changePage(), a touch event or a sendme reply.
+    void enableShadowCache(const NextionComponent &component, NextionShadowEntry &entry);
+    void invalidateShadowCache();
+    void invalidateShadowCache(uint8_t pageId);
+    void invalidateShadowCache(const NextionComponent &component);
+
+    // setInteger() on the component then writes at most once per minInterval ms and skips changes
+    // smaller than deadband from the value last written. The newest held value is written by update()
+    // once the interval has passed.
+    void enableRateLimit(const NextionComponent &component, NextionRateLimit &limit, uint16_t minInterval, uint32_t deadband = 0);
+
+    // Sends samples to a waveform channel as one binary block (addt) instead of an add command per
+    // sample. Blocks until the display is ready to take them. Fails while the display is still busy
+    // with the previous block or when it does not answer. Commands sent from callbacks in the meantime
+    // are held in the batch when batching is enabled and dropped otherwise. Rate-limited values and
+    // deferred writes due in the meantime wait for the next update().
+    bool addWaveformSamples(const NextionComponent &waveform, uint8_t channel, const uint8_t *samples, uint16_t count);
+
+    // Registered channels are streamed by update(), one block at a time in turn
+    void registerWaveformChannel(NextionWaveformChannel &channel);
+    [[nodiscard]] bool isStreamingWaveform() const;
+
+    // Texts too long for the transmit buffer are written at once, in parts. False when the text could
+    // not be sent: while transparent data is pending, or when too long to be held for a page not shown.
+    bool setText(const NextionComponent &component, const char *value);
     void setInteger(const NextionComponent &component, int value);
 
-    void getText(NextionComponent &component);
-    void getInteger(NextionComponent &component);
+    // A typed component only takes the attribute of its type, e.g. a NextionNumber has no text
+    bool setText(const NextionTypedComponent<NextionConstants::Attribute::Value> &component, const char *value) = delete;
+    void setInteger(const NextionTypedComponent<NextionConstants::Attribute::Text> &component, int value) = delete;
+
+    // Same as setting each component in turn, but the frames are written to the stream together: at once
+    // when batching, otherwise as many at a time as the transmit buffer holds. Colors take one of the
+    // color attributes.
+    void setTexts(const NextionComponent *const *components, const char *const *values, size_t count);
+    void setIntegers(const NextionComponent *const *components, const int *values, size_t count);
+    void setColors(const NextionComponent *const *components, NextionConstants::Attribute attribute, const uint16_t *colors, size_t count);
+
+    bool getText(const NextionComponent &component);
+    bool getInteger(const NextionComponent &component);
+    bool getText(const NextionTypedComponent<NextionConstants::Attribute::Value> &component) = delete;
+    bool getInteger(const NextionTypedComponent<NextionConstants::Attribute::Text> &component) = delete;
+    [[nodiscard]] uint8_t pendingRequestCount() const;
 
     template <typename T>
     void changePage(const T &page)
     {
         sendCommand(NextionConstants::Command::ChangePage, page);
+
+        // Components on the new page start from their designer values
+        invalidateShadowCache();
+        trackPageChange(page);
     }
 
     void changePage(const NextionComponent &) = delete;
@@ -95,9 +270,10 @@ public:
     template <typename T>
     void click(const T &item, NextionConstants::ClickEvent event)
     {
-        writeCommand(NextionConstants::Command::Click);
-        sendParameterList(item, static_cast<uint8_t>(event));
-        writeTerminationBytes();
+        auto frame = beginFrame();
+        writeCommand(frame, NextionConstants::Command::Click);
+        sendParameterList(frame, item, static_cast<uint8_t>(event));
+        sendFrame(frame);
     }
 
     void getCurrentPageId();
@@ -114,9 +290,10 @@ public:
     template <typename T>
     void setTouchEvent(T item, bool enable)
     {
-        writeCommand(NextionConstants::Command::EnableTouchEvent);
-        sendParameterList(item, enable ? 1 : 0);
-        writeTerminationBytes();
+        auto frame = beginFrame();
+        writeCommand(frame, NextionConstants::Command::EnableTouchEvent);
+        sendParameterList(frame, item, enable ? 1 : 0);
+        sendFrame(frame);
     }
 
     template <typename T>
@@ -131,14 +308,29 @@ public:
         setTouchEvent(item, false);
     }
 
+    // Writes to components made while the display sleeps are held like those to hidden pages (see
+    // enableDeferredWrites), latest value only, and sent in one burst when it wakes. Sleeping on its own
+    // (thsp / ussp) is learnt from the display.
     void sleep(bool sleepMode);
+    [[nodiscard]] bool isSleeping() const;
+
+    // Backlight in percent (dim=), 100 and above is full brightness
+    void setBrightness(uint8_t brightness);
+
+    // Updates to the screen are held by the display between these (ref_stop / ref_star)
+    void stopRefresh();
+    void startRefresh();
 
     void setDate(uint8_t day, uint8_t month, uint16_t year);
-    void getDate();
+    bool getDate();
     void setTime(uint8_t hour, uint8_t minute, uint8_t second);
-    void getTime();
-    char *getDayOfTheWeek(NextionConstants::DayOfTheWeek day);
+    bool getTime();
+    // Empty for a value outside DayOfTheWeek, e.g. an unset date
+    const __FlashStringHelper *getDayOfTheWeek(NextionConstants::DayOfTheWeek day);
     DateTime getDateTime();
+    bool requestDateTime();
+    [[nodiscard]] bool isDateTimePending() const;
+    [[nodiscard]] const DateTime &dateTime() const;
 
     void setBackgroundColor(const NextionComponent &component, NextionConstants::Color color);
     void setBackgroundColor2(const NextionComponent &component, NextionConstants::Color color);
@@ -155,73 +347,259 @@ public:
     void setForegroundColor(const char *objectName, uint16_t color);
     void setForegroundColor2(const char *objectName, uint16_t color);
 
-    void (*onTouchEvent)(uint8_t pageId, ComponentId componentId, NextionConstants::ClickEvent event);
-    void (*onPageIdUpdated)(uint8_t pageId);
-    void (*onNumericDataReceived)(const NextionComponent *component, int32_t data);
-    void (*onStringDataReceived)(const NextionComponent *component, char *data);
-    void (*onUnhandledReturnCodeReceived)(uint8_t returnCode);
+    void (*onTouchEvent)(uint8_t pageId, ComponentId componentId, NextionConstants::ClickEvent event) = nullptr;
+    void (*onPageIdUpdated)(uint8_t pageId) = nullptr;
 
-private:
-    Stream *m_stream;
-    uint8_t m_buffer[NextionConstants::MAX_BUFFER_SIZE];
-    uint8_t m_currentIndex;
-    LinkedList<NextionComponent *> m_components;
+    // Needs sendxy=1. A drag is reported once per update() with its latest position, presses and
+    // releases are always reported.
+    void (*onTouchCoordinate)(uint16_t x, uint16_t y, NextionConstants::ClickEvent event) = nullptr;
 
-    NextionComponent *m_componentRetrievingText;
-    NextionComponent *m_componentRetrievingInteger;
+    void (*onNumericDataReceived)(const NextionComponent *component, int32_t data) = nullptr;
+    void (*onStringDataReceived)(const NextionComponent *component, char *data) = nullptr;
+    void (*onUnhandledReturnCodeReceived)(uint8_t returnCode) = nullptr;
+    void (*onDateTimeReceived)(const DateTime &dateTime) = nullptr;
+    void (*onBaudRateChange)(uint32_t baudRate) = nullptr;
+    void (*onCommandCompleted)(uint16_t commandId) = nullptr;
+    void (*onCommandFailed)(uint16_t commandId, NextionConstants::ReturnCode error) = nullptr;
+    void (*onCommandUnconfirmed)(uint16_t commandId) = nullptr;
+    void (*onSleepChanged)(bool isSleeping) = nullptr;
 
-    NextionComponent *m_componentYear;
-    NextionComponent *m_componentMonth;
-    NextionComponent *m_componentDay;
-    NextionComponent *m_componentHour;
-    NextionComponent *m_componentMinute;
-    NextionComponent *m_componentSecond;
-    NextionComponent *m_componentDayOfTheWeek;
+    // Sets every component to its initial value, called by begin() once the display is ready
+    void (*onInitialState)() = nullptr;
+
+private:
+    template <NextionConstants::Attribute MainAttribute>
+    friend class NextionTypedComponent;
+
+    Stream *m_stream;
+    uint8_t *m_buffer;
+    uint16_t m_bufferSize;
+    uint16_t m_currentIndex;
+    uint8_t *m_frame;
+    uint16_t m_frameSize;
+    uint8_t m_expectedLength;
+    uint8_t m_terminationBytesSeen;
+    bool m_isDiscarding;
+    uint8_t *m_txBuffer;
+    uint16_t m_txBufferSize;
+    uint16_t m_stagedSize;
+    bool m_isStaging;
+    NextionFrameQueue m_txQueue;
+    uint16_t m_flushDelay;
+    unsigned long m_batchStartedAt;
+    NextionComponentRegistry m_components;
+
+    NextionRequest *m_requests;
+    uint8_t m_maxRequests;
+    uint8_t m_requestHead;
+    uint8_t m_requestCount;
+
+    NextionShadowEntry *m_shadowEntries;
+    NextionRateLimit *m_rateLimits;
+
+    NextionPendingCommand *m_window;
+    uint8_t m_windowSize;
+    uint8_t m_windowHead;
+    uint8_t m_windowCount;
+    uint8_t m_untrackedCount;
+    uint8_t m_maxRetries;
+    uint16_t m_nextCommandId;
+    uint16_t m_lastCommandId;
+    unsigned long m_lastReplyAt;
+    NextionFrameQueue m_retryQueue;
+
+    uint16_t m_flowBudget;
+    uint32_t m_drainRate;
+    uint8_t m_flowBackoff;
+    unsigned long m_backedOffAt;
+    uint32_t m_bytesInFlight;
+    unsigned long m_drainedAt;
+    NextionFrameQueue m_heldFrames;
+    NextionFrameQueue m_resendFrames;
+    size_t m_resendBytes;
+
+#if NEXTION_ENABLE_METRICS
+    NextionMetrics m_metrics{};
+    bool m_isPageIdRequested = false;
+    unsigned long m_pageIdRequestedAt = 0;
+#endif
+
+    bool m_isPageIdReceived;
+    bool m_isReadyReceived;
+
+    uint16_t m_touchX;
+    uint16_t m_touchY;
+    bool m_isTouchPressed;
+    bool m_isTouchMovePending;
+
+    uint8_t m_currentPageId;
+    bool m_isCurrentPageKnown;
+    bool m_isSleeping;
+    bool m_isDeferredReleasePending;
+    NextionFrameQueue m_deferredWrites;
+
+    NextionEvent *m_events;
+    uint8_t m_eventCapacity;
+    char *m_eventTexts;
+    uint16_t m_eventTextSize;
+    volatile uint8_t m_eventHead;
+    volatile uint8_t m_eventTail;
+    bool m_isEventQueueFull;
+    uint32_t m_droppedEvents;
+    uint32_t m_eventOverflows;
+
+    uint8_t *m_receivedFrames;
+    uint8_t m_receivedCapacity;
+    volatile uint8_t m_receivedHead;
+    volatile uint8_t m_receivedTail;
+    uint32_t m_droppedReceivedFrames;
+
+    NextionWaveformChannel *m_waveformChannels;
+    NextionWaveformChannel *m_nextWaveformChannel;
+    bool m_isWaveformBusy;
+    bool m_isTransparentDataPending;
+    bool m_isTransparentDataReady;
+    unsigned long m_waveformStartedAt;
+    uint16_t m_waveformBlockSize;
+
+    DateTime m_dateTime;
+    uint8_t m_pendingRtcFields;
+    bool m_isRtcRequestFailed;
 
     [[nodiscard]] bool waitForResponse();
+    [[nodiscard]] bool waitForPageId();
 
+    [[nodiscard]] bool parse(uint8_t byte);
     [[nodiscard]] bool isBufferTerminated();
+    [[nodiscard]] uint8_t countTrailingTerminationBytes() const;
+    [[nodiscard]] bool processFrame(uint8_t *frame, uint16_t size);
+    [[nodiscard]] bool processReceivedFrames();
+    [[nodiscard]] uint8_t *receivedFrameAt(uint8_t position) const;
     [[nodiscard]] bool processBuffer();
-    [[nodiscard]] uint8_t payloadSize();
+    [[nodiscard]] uint16_t payloadSize();
+    void emitTouchMove();
+    void emitCommandEvent(NextionEventType type, uint16_t commandId, NextionConstants::ReturnCode result = NextionConstants::ReturnCode::InstructionSuccessful);
+    void emitUnhandledReturnCode(NextionConstants::ReturnCode returnCode);
+    bool emitEvent(NextionEvent &event);
+    void queueEventText(uint8_t slot, const char *text);
+    bool deliverEvent(NextionEvent &event);
+
+    [[nodiscard]] bool pushRequest(const NextionComponent *component, NextionConstants::ReturnCode expectedReturnCode, NextionConstants::Command rtcField = NextionConstants::Command::Get);
+    [[nodiscard]] bool popRequest(NextionConstants::ReturnCode returnCode, NextionRequest &request);
+    void expireRequests();
+    void stampRequest();
+    void cancelRequest();
+    void skipRequest();
+    void dropRequest(const NextionRequest &request);
+
+    void trackFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+    void trackCommand(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+    void pushCommand(uint16_t id, uint8_t attempts, NextionConstants::ReturnCode expectedReply, bool hasCopy, uint16_t length);
+    [[nodiscard]] NextionPendingCommand popCommand();
+    void supersedeRetries(const uint8_t *frame, uint8_t keyLength);
+    void releaseCommand(const NextionPendingCommand &command);
+    [[nodiscard]] bool matchCommandReply(NextionConstants::ReturnCode returnCode);
+    [[nodiscard]] bool resendCommand(const NextionPendingCommand &command);
+    void expireCommands();
+    void discardCommands();
+
+    void paceFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+    void writeFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+    void releaseHeldFrames(bool isForced);
+    void writeCreditedFrames(NextionFrameQueue &queue, bool isForced);
+    void keepForResend(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+    void creditDrainedBytes();
+    void creditBytes(uint32_t size);
+    [[nodiscard]] bool hasCredit(uint16_t length) const;
+    [[nodiscard]] uint32_t flowLimit() const;
+    void recoverFromOverflow();
+
+    void switchHostBaudRate(uint32_t baudRate);
+
+    [[nodiscard]] bool beginTransparentData(const NextionComponent &waveform, uint8_t channel, uint16_t count);
+    void streamWaveformChannels();
+
+    bool requestRtcFields(const NextionConstants::Command *fields, uint8_t count);
+    void setRtcField(NextionConstants::Command field, int32_t value);
+
+    [[nodiscard]] NextionShadowEntry *findShadowEntry(const NextionComponent &component) const;
+    [[nodiscard]] NextionRateLimit *findRateLimit(const NextionComponent &component) const;
+    [[nodiscard]] bool isRateLimited(const NextionComponent &component, int32_t value);
+    void releaseRateLimitedValues();
+    void writeAttribute(const NextionComponent &component, NextionConstants::Attribute attribute, int32_t value, const char *prefix = nullptr, uint8_t prefixLength = 0);
+    bool writeText(const NextionComponent &component, const char *value, const char *prefix = nullptr, uint8_t prefixLength = 0);
+    void appendPrefix(NextionFrameBuilder &frame, const NextionComponent &component, NextionConstants::Attribute attribute, const char *prefix, uint8_t prefixLength);
+
+    [[nodiscard]] NextionFrameBuilder beginFrame();
+    void beginStaging();
+    void endStaging();
+    void transmitStaged();
+    static uint8_t *unstageFrame(void *owner, const uint8_t *frame, size_t size);
+    bool sendFrame(NextionFrameBuilder &frame, size_t keyLength = 0, const NextionComponent *target = nullptr);
+    void dropFrame(NextionConstants::ReturnCode expectedReply);
+    [[nodiscard]] bool beginStreamedFrame();
+    void endStreamedFrame();
+    bool submitFrame(const uint8_t *frame, uint16_t length, uint8_t keyLength, NextionConstants::ReturnCode expectedReply);
+
+    [[nodiscard]] bool isDeferred(uint8_t pageId) const;
+    void setCurrentPage(uint8_t pageId);
+    void setSleeping(bool isSleeping);
+    void releaseDeferredWrites();
+    void trackPageChange(const char *page);
+    void trackPageChange(char *page);
+    void trackPageChange(const __FlashStringHelper *page);
 
-    void writeTerminationBytes();
-    void writeCommand(const NextionConstants::Command &command);
-    [[nodiscard]] const char *getCommand(const NextionConstants::Command &command);
+    template <typename T>
+    void trackPageChange(T pageId)
+    {
+        setCurrentPage(static_cast<uint8_t>(pageId));
+    }
+    void transmit(const uint8_t *data, size_t size);
+
+    void writeCommand(NextionFrameBuilder &frame, const NextionConstants::Command &command);
 
     void sendCommand(const NextionConstants::Command &command);
-    void sendCommand(const NextionConstants::Command &command, const NextionComponent &component);
 
     template <typename T>
     void sendCommand(const NextionConstants::Command &command, const T &payload)
     {
-        writeCommand(command);
-        m_stream->print(payload);
-        writeTerminationBytes();
+        auto frame = beginFrame();
+        writeCommand(frame, command);
+        appendParameter(frame, payload);
+        sendFrame(frame);
     }
 
     template <typename T>
-    void sendParameterList(const T &param)
+    void appendParameter(NextionFrameBuilder &frame, T value)
     {
-        m_stream->print(param);
+        frame.appendInteger(static_cast<int32_t>(value));
     }
 
-    void sendParameterList(const NextionComponent &component);
+    void appendParameter(NextionFrameBuilder &frame, const char *value);
+    void appendParameter(NextionFrameBuilder &frame, char *value);
+    void appendParameter(NextionFrameBuilder &frame, const __FlashStringHelper *value);
+    void appendParameter(NextionFrameBuilder &frame, const NextionComponent &component);
+    void appendParameter(NextionFrameBuilder &frame, NextionConstants::Command command);
+    void appendAttribute(NextionFrameBuilder &frame, NextionConstants::Attribute attribute);
+
+    template <typename T>
+    void sendParameterList(NextionFrameBuilder &frame, const T &param)
+    {
+        appendParameter(frame, param);
+    }
 
     template <typename TFirst, typename... TRest>
-    void sendParameterList(const TFirst &first, TRest... rest)
+    void sendParameterList(NextionFrameBuilder &frame, const TFirst &first, TRest... rest)
     {
-        sendParameterList(first);
+        sendParameterList(frame, first);
 
         if (sizeof...(rest) > 0)
         {
-            m_stream->print(NextionConstants::PARAMETER_SEPARATOR);
-            sendParameterList(rest...);
+            frame.append(NextionConstants::PARAMETER_SEPARATOR);
+            sendParameterList(frame, rest...);
         }
     }
 
-    void setText(const char *objectName, const char *value);
-    void setInteger(const char *objectName, int value);
-
     template <typename T>
     void get(T item)
     {
@@ -232,16 +610,94 @@ private:
     template <typename T>
     void set(NextionConstants::Command command, T item)
     {
-        m_stream->print(getCommand(command));
-        m_stream->write(NextionConstants::ASSIGNMENT_CHARACTER);
-        m_stream->print(item);
-        writeTerminationBytes();
+        auto frame = beginFrame();
+        appendParameter(frame, command);
+        frame.append(NextionConstants::ASSIGNMENT_CHARACTER);
+        const auto keyLength = frame.size();
+        appendParameter(frame, item);
+        sendFrame(frame, keyLength);
     }
 
-    void getText(const char *objectName);
-    void getInteger(const char *objectName);
+    template <typename T>
+    void getAttribute(const T &object, NextionConstants::Attribute attribute)
+    {
+        auto frame = beginFrame();
+        writeCommand(frame, NextionConstants::Command::Get);
+        appendParameter(frame, object);
+        appendAttribute(frame, attribute);
+        sendFrame(frame);
+    }
 
-    void convert(const char *source, const char *destination, uint8_t length, NextionConstants::ConversionFormat format);
+    template <typename TSource, typename TDestination>
+    void convert(const TSource &source, NextionConstants::Attribute sourceAttribute, const TDestination &destination, NextionConstants::Attribute destinationAttribute, uint8_t length, NextionConstants::ConversionFormat format)
+    {
+        auto frame = beginFrame();
+        writeCommand(frame, NextionConstants::Command::Convert);
+        appendParameter(frame, source);
+        appendAttribute(frame, sourceAttribute);
+        frame.append(NextionConstants::PARAMETER_SEPARATOR);
+        appendParameter(frame, destination);
+        appendAttribute(frame, destinationAttribute);
+        frame.append(NextionConstants::PARAMETER_SEPARATOR);
+        sendParameterList(frame, length, static_cast<uint8_t>(format));
+        sendFrame(frame);
+    }
 
-    void setColor(const char *objectName, const char *attribute, const uint16_t color);
+    template <typename T>
+    void sendVisibility(const T &object, bool visible)
+    {
+        auto frame = beginFrame();
+        writeCommand(frame, NextionConstants::Command::SetVisibility);
+        sendParameterList(frame, object, visible ? 1 : 0);
+        sendFrame(frame);
+    }
+
+    template <typename T>
+    void setColor(const T &object, NextionConstants::Attribute attribute, const uint16_t color)
+    {
+        auto frame = beginFrame();
+        appendParameter(frame, object);
+        appendAttribute(frame, attribute);
+        frame.append(NextionConstants::ASSIGNMENT_CHARACTER);
+        const auto keyLength = frame.size();
+        frame.appendUnsigned(color);
+        sendFrame(frame, keyLength);
+    }
 };
+
+// Owns the buffers of the interface, sized at compile time.
+//
+// RxBytes bounds the longest reply that can be received (string data included), TxBytes the longest
+// command that can be sent (and how many bulk writes are sent at once) and MaxInFlight the number of get
+// requests awaiting a reply. Reading the date and time at once takes seven of these, and a request that
+// timed out keeps its place a while longer in case its reply is only late. MaxComponents bounds
+// the registered components, 0 lets the registry grow on the heap instead.
+template <uint16_t RxBytes = NextionConstants::MAX_BUFFER_SIZE,
+          uint16_t TxBytes = NextionConstants::MAX_FRAME_SIZE,
+          uint8_t MaxInFlight = NextionConstants::MAX_PENDING_REQUESTS,
+          uint16_t MaxComponents = 0>
+class BasicNextionInterface : public NextionInterfaceBase
+{
+    static_assert(RxBytes >= NextionConstants::ExpectedPayloadSize::NUMERIC_DATA_ENCLOSED + NextionConstants::TERMINATION_BYTES_SIZE,
+                  "The receive buffer cannot hold a numeric data frame");
+    static_assert(RxBytes >= NextionConstants::ExpectedPayloadSize::TOUCH_EVENT + NextionConstants::TERMINATION_BYTES_SIZE,
+                  "The receive buffer cannot hold a touch event frame");
+    static_assert(TxBytes > NextionConstants::TERMINATION_BYTES_SIZE, "The transmit buffer cannot hold any command");
+    static_assert(MaxInFlight > 0, "At least one request must be allowed in flight");
+    static_assert(MaxComponents > 0 || !NEXTION_DISABLE_HEAP, "Without the heap, MaxComponents must leave room for the components");
+
+public:
+    explicit BasicNextionInterface(Stream &stream)
+        : NextionInterfaceBase(stream, m_rxStorage, RxBytes, m_txStorage, TxBytes, m_requestStorage, MaxInFlight,
+                               MaxComponents > 0 ? m_componentStorage : nullptr, MaxComponents)
+    {
+    }
+
+private:
+    uint8_t m_rxStorage[RxBytes];
+    uint8_t m_txStorage[TxBytes];
+    NextionRequest m_requestStorage[MaxInFlight];
+    const NextionComponent *m_componentStorage[MaxComponents > 0 ? MaxComponents : 1];
+};
+
+using NextionInterface = BasicNextionInterface<>;
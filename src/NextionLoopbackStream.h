@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Stands in for the display in memory, for tests and benchmarks. What is written is kept until
+// clearWritten(), and what is fed is read back, e.g. the replies the display would send. Fixed storage,
+// Capacity bytes each way, nothing is allocated.
+template <size_t Capacity = 1024>
+class NextionLoopbackStream : public Stream
+{
+public:
+    size_t write(uint8_t byte) override
+    {
+        return write(&byte, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        m_writeCalls++;
+        m_bytesWritten += size;
+
+        for (size_t i = 0; i < size && m_writtenSize < Capacity; i++)
+        {
+            m_written[m_writtenSize++] = buffer[i];
+        }
+
+        return size;
+    }
+
+    int available() override
+    {
+        return static_cast<int>(m_rxSize - m_rxPosition);
+    }
+
+    int read() override
+    {
+        return m_rxPosition < m_rxSize ? m_rx[m_rxPosition++] : -1;
+    }
+
+    int peek() override
+    {
+        return m_rxPosition < m_rxSize ? m_rx[m_rxPosition] : -1;
+    }
+
+    // False when it does not fit behind what is still unread
+    bool feed(const uint8_t *data, size_t size)
+    {
+        if (m_rxPosition == m_rxSize)
+        {
+            m_rxPosition = 0;
+            m_rxSize = 0;
+        }
+
+        if (Capacity - m_rxSize < size)
+        {
+            return false;
+        }
+
+        memcpy(&m_rx[m_rxSize], data, size);
+        m_rxSize += size;
+        return true;
+    }
+
+    // Up to Capacity bytes are kept, bytesWritten() counts them all
+    [[nodiscard]] const uint8_t *written() const
+    {
+        return m_written;
+    }
+
+    [[nodiscard]] size_t writtenSize() const
+    {
+        return m_writtenSize;
+    }
+
+    [[nodiscard]] uint32_t bytesWritten() const
+    {
+        return m_bytesWritten;
+    }
+
+    [[nodiscard]] uint32_t writeCalls() const
+    {
+        return m_writeCalls;
+    }
+
+    void clearWritten()
+    {
+        m_writtenSize = 0;
+        m_bytesWritten = 0;
+        m_writeCalls = 0;
+    }
+
+private:
+    uint8_t m_written[Capacity];
+    size_t m_writtenSize = 0;
+    uint32_t m_bytesWritten = 0;
+    uint32_t m_writeCalls = 0;
+
+    uint8_t m_rx[Capacity];
+    size_t m_rxSize = 0;
+    size_t m_rxPosition = 0;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionConstants.h"
+
+namespace NextionConstants
+{
+    // Upper bounds (exclusive, in ms) of the latency histogram buckets, the last bucket holds the rest
+    constexpr uint16_t LATENCY_BUCKET_LIMITS[] = {2, 5, 10, 20, 50, 100};
+    constexpr auto LATENCY_BUCKET_COUNT = sizeof(LATENCY_BUCKET_LIMITS) / sizeof(LATENCY_BUCKET_LIMITS[0]) + 1;
+
+    constexpr uint8_t KNOWN_RETURN_CODES[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x09, 0x11, 0x12, 0x1A,
+                                              0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x23, 0x24, 0x65, 0x66, 0x67,
+                                              0x68, 0x70, 0x71, 0x86, 0x87, 0x88, 0x89, 0xFD, 0xFE};
+    constexpr auto KNOWN_RETURN_CODE_COUNT = sizeof(KNOWN_RETURN_CODES) / sizeof(KNOWN_RETURN_CODES[0]);
+}
+
+struct NextionMetrics
+{
+    uint32_t txBytes;
+    uint32_t rxBytes;
+
+    // Complete frames per return code, the last slot counts codes missing from ReturnCode
+    uint32_t frames[NextionConstants::KNOWN_RETURN_CODE_COUNT + 1];
+
+    uint32_t bufferOverflows;
+    uint32_t resyncs;
+    uint32_t payloadSizeRejections;
+    uint32_t unhandledReturnCodes;
+    uint32_t droppedFrames;
+    uint32_t resentFrames;
+    uint32_t timeouts;
+
+    // Time from sending a get (or sendme) to receiving its reply
+    uint32_t getLatency[NextionConstants::LATENCY_BUCKET_COUNT];
+    uint32_t sendmeLatency[NextionConstants::LATENCY_BUCKET_COUNT];
+
+    [[nodiscard]] uint32_t framesReceived(NextionConstants::ReturnCode returnCode) const
+    {
+        return frames[returnCodeSlot(static_cast<uint8_t>(returnCode))];
+    }
+
+    void countFrame(uint8_t returnCode)
+    {
+        frames[returnCodeSlot(returnCode)]++;
+    }
+
+    static void recordLatency(uint32_t *histogram, unsigned long latency)
+    {
+        uint8_t bucket = 0;
+
+        while (bucket < NextionConstants::LATENCY_BUCKET_COUNT - 1 && latency >= NextionConstants::LATENCY_BUCKET_LIMITS[bucket])
+        {
+            bucket++;
+        }
+
+        histogram[bucket]++;
+    }
+
+private:
+    [[nodiscard]] static uint8_t returnCodeSlot(uint8_t returnCode)
+    {
+        uint8_t slot = 0;
+
+        while (slot < NextionConstants::KNOWN_RETURN_CODE_COUNT && NextionConstants::KNOWN_RETURN_CODES[slot] != returnCode)
+        {
+            slot++;
+        }
+
+        return slot;
+    }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionComponent.h"
+
+// Limits how often the value of a component is written. Values arriving faster than the minimum interval
+// are held, newest only, and written once it has passed. Changes smaller than the deadband are not
+// written at all.
+class NextionRateLimit
+{
+public:
+    [[nodiscard]] bool hasPendingValue() const
+    {
+        return m_hasPendingValue;
+    }
+
+private:
+    friend class NextionInterfaceBase;
+
+    const NextionComponent *m_component = nullptr;
+    NextionRateLimit *m_next = nullptr;
+    uint16_t m_minInterval = 0;
+    uint32_t m_deadband = 0;
+    unsigned long m_sentAt = 0;
+    int32_t m_sentValue = 0;
+    int32_t m_pendingValue = 0;
+    bool m_hasSentValue = false;
+    bool m_hasPendingValue = false;
+};
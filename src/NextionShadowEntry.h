@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionComponent.h"
+#include "NextionConstants.h"
+
+// Remembers the last values written to a component so that repeated writes of the same value can be
+// skipped. Text is remembered by its hash only.
+class NextionShadowEntry
+{
+    static_assert(NextionConstants::ATTRIBUTE_COUNT <= 8, "Valid attributes are kept in a single byte");
+
+public:
+    [[nodiscard]] bool isCached(NextionConstants::Attribute attribute, uint32_t value) const
+    {
+        const auto index = static_cast<uint8_t>(attribute);
+        return (m_validAttributes & (1 << index)) != 0 && m_values[index] == value;
+    }
+
+    void store(NextionConstants::Attribute attribute, uint32_t value)
+    {
+        const auto index = static_cast<uint8_t>(attribute);
+        m_values[index] = value;
+        m_validAttributes |= 1 << index;
+    }
+
+    void invalidate()
+    {
+        m_validAttributes = 0;
+    }
+
+private:
+    friend class NextionInterfaceBase;
+
+    const NextionComponent *m_component = nullptr;
+    NextionShadowEntry *m_next = nullptr;
+    uint32_t m_values[NextionConstants::ATTRIBUTE_COUNT]{};
+    uint8_t m_validAttributes = 0;
+};
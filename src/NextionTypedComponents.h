@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionInterface.h"
+
+// A component that only offers the attributes its type has on the display, so that writing one it does
+// not have fails to compile instead of being answered with InvalidVariableNameOrAttribute. The
+// "<name><suffix>=" prefix of its main attribute is formatted once, writing it then only appends the
+// value. Names too long for the prefix are formatted on every write instead.
+template <NextionConstants::Attribute MainAttribute>
+class NextionTypedComponent : public NextionComponent
+{
+public:
+    NextionTypedComponent(uint8_t pageId, ComponentId id, const char *name, NameStorage storage = NameStorage::Ram)
+        : NextionComponent(pageId, id, name, storage)
+    {
+        formatPrefix();
+    }
+
+    NextionTypedComponent(uint8_t pageId, ComponentId id, const __FlashStringHelper *name)
+        : NextionComponent(pageId, id, name)
+    {
+        formatPrefix();
+    }
+
+    void setBackgroundColor(NextionInterfaceBase &hmi, uint16_t color) const
+    {
+        hmi.writeAttribute(*this, NextionConstants::Attribute::Background, color);
+    }
+
+    void setBackgroundColor(NextionInterfaceBase &hmi, NextionConstants::Color color) const
+    {
+        setBackgroundColor(hmi, static_cast<uint16_t>(color));
+    }
+
+    void setForegroundColor(NextionInterfaceBase &hmi, uint16_t color) const
+    {
+        hmi.writeAttribute(*this, NextionConstants::Attribute::Foreground, color);
+    }
+
+    void setForegroundColor(NextionInterfaceBase &hmi, NextionConstants::Color color) const
+    {
+        setForegroundColor(hmi, static_cast<uint16_t>(color));
+    }
+
+protected:
+    // Subject to the rate limit of the component, like setInteger()
+    void writeMainValue(NextionInterfaceBase &hmi, int32_t value) const
+    {
+        if (!hmi.isRateLimited(*this, value))
+        {
+            hmi.writeAttribute(*this, MainAttribute, value, m_prefix, m_prefixLength);
+        }
+    }
+
+    bool writeMainText(NextionInterfaceBase &hmi, const char *value) const
+    {
+        return hmi.writeText(*this, value, m_prefix, m_prefixLength);
+    }
+
+    void writeAttribute(NextionInterfaceBase &hmi, NextionConstants::Attribute attribute, int32_t value) const
+    {
+        hmi.writeAttribute(*this, attribute, value);
+    }
+
+private:
+    char m_prefix[NextionConstants::MAX_COMPONENT_NAME_LENGTH + 8];
+    uint8_t m_prefixLength = 0;
+
+    void formatPrefix()
+    {
+        const auto suffix = NextionConstants::ATTRIBUTE_SUFFIXES[static_cast<uint8_t>(MainAttribute)].suffix;
+        uint8_t length = 0;
+
+        if (!copyPrefix(name(), isNameInFlash(), length) || !copyPrefix(suffix, true, length) || length >= sizeof(m_prefix))
+        {
+            m_prefixLength = 0;
+            return;
+        }
+
+        m_prefix[length++] = NextionConstants::ASSIGNMENT_CHARACTER;
+        m_prefixLength = length;
+    }
+
+    bool copyPrefix(const char *text, bool isInFlash, uint8_t &length)
+    {
+        for (;; text++)
+        {
+            const auto character = isInFlash ? static_cast<char>(pgm_read_byte(text)) : *text;
+
+            if (character == '\0')
+            {
+                return true;
+            }
+
+            if (length >= sizeof(m_prefix))
+            {
+                return false;
+            }
+
+            m_prefix[length++] = character;
+        }
+    }
+};
+
+class NextionNumber : public NextionTypedComponent<NextionConstants::Attribute::Value>
+{
+public:
+    using NextionTypedComponent::NextionTypedComponent;
+
+    void setValue(NextionInterfaceBase &hmi, int32_t value) const
+    {
+        writeMainValue(hmi, value);
+    }
+
+    // Answered through onNumericDataReceived
+    bool getValue(NextionInterfaceBase &hmi)
+    {
+        return hmi.getInteger(*this);
+    }
+};
+
+class NextionText : public NextionTypedComponent<NextionConstants::Attribute::Text>
+{
+public:
+    using NextionTypedComponent::NextionTypedComponent;
+
+    bool setText(NextionInterfaceBase &hmi, const char *value) const
+    {
+        return writeMainText(hmi, value);
+    }
+
+    // Answered through onStringDataReceived
+    bool getText(NextionInterfaceBase &hmi)
+    {
+        return hmi.getText(*this);
+    }
+};
+
+class NextionSlider : public NextionTypedComponent<NextionConstants::Attribute::Value>
+{
+public:
+    using NextionTypedComponent::NextionTypedComponent;
+
+    void setValue(NextionInterfaceBase &hmi, int32_t value) const
+    {
+        writeMainValue(hmi, value);
+    }
+
+    void setMinValue(NextionInterfaceBase &hmi, int32_t value) const
+    {
+        writeAttribute(hmi, NextionConstants::Attribute::MinValue, value);
+    }
+
+    void setMaxValue(NextionInterfaceBase &hmi, int32_t value) const
+    {
+        writeAttribute(hmi, NextionConstants::Attribute::MaxValue, value);
+    }
+
+    bool getValue(NextionInterfaceBase &hmi)
+    {
+        return hmi.getInteger(*this);
+    }
+};
+
+class NextionGauge : public NextionTypedComponent<NextionConstants::Attribute::Value>
+{
+public:
+    using NextionTypedComponent::NextionTypedComponent;
+
+    // 0 to 360 degrees
+    void setValue(NextionInterfaceBase &hmi, uint16_t angle) const
+    {
+        writeMainValue(hmi, angle);
+    }
+
+    bool getValue(NextionInterfaceBase &hmi)
+    {
+        return hmi.getInteger(*this);
+    }
+};
+
+class NextionProgressBar : public NextionTypedComponent<NextionConstants::Attribute::Value>
+{
+public:
+    using NextionTypedComponent::NextionTypedComponent;
+
+    // 0 to 100 percent
+    void setValue(NextionInterfaceBase &hmi, uint8_t percent) const
+    {
+        writeMainValue(hmi, percent);
+    }
+
+    bool getValue(NextionInterfaceBase &hmi)
+    {
+        return hmi.getInteger(*this);
+    }
+};
+
+// Has no value of its own, samples are added to its channels
+class NextionWaveform : public NextionComponent
+{
+public:
+    using NextionComponent::NextionComponent;
+
+    bool addSamples(NextionInterfaceBase &hmi, uint8_t channel, const uint8_t *samples, uint16_t count) const
+    {
+        return hmi.addWaveformSamples(*this, channel, samples, count);
+    }
+
+    void setBackgroundColor(NextionInterfaceBase &hmi, uint16_t color) const
+    {
+        hmi.setBackgroundColor(*this, color);
+    }
+
+    void setBackgroundColor(NextionInterfaceBase &hmi, NextionConstants::Color color) const
+    {
+        hmi.setBackgroundColor(*this, color);
+    }
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "Arduino.h"
 
 namespace Utils
@@ -9,4 +11,18 @@ namespace Utils
         b >>= 3;
         return r | g | b;
     }
+
+    // 32-bit FNV-1a
+    [[nodiscard]] inline uint32_t hash(const char *text)
+    {
+        uint32_t result = 2166136261UL;
+
+        while (*text != '\0')
+        {
+            result ^= static_cast<uint8_t>(*text++);
+            result *= 16777619UL;
+        }
+
+        return result;
+    }
 }
\ No newline at end of file
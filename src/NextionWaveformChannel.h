@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Arduino.h"
+#include "NextionComponent.h"
+
+// Samples waiting to be streamed to one channel of a waveform, kept in caller-provided storage. The
+// interface sends whatever has accumulated each time the display has taken the previous block, so a
+// full buffer means the display is falling behind and new samples are dropped.
+class NextionWaveformChannel
+{
+public:
+    NextionWaveformChannel(const NextionComponent &waveform, uint8_t channel, uint8_t *buffer, uint16_t capacity)
+        : m_waveform(&waveform), m_channel(channel), m_buffer(buffer), m_capacity(capacity)
+    {
+    }
+
+    NextionWaveformChannel(const NextionWaveformChannel &) = delete;
+    NextionWaveformChannel &operator=(const NextionWaveformChannel &) = delete;
+
+    bool push(uint8_t sample)
+    {
+        if (m_size >= m_capacity)
+        {
+            m_droppedSamples++;
+            return false;
+        }
+
+        m_buffer[(m_head + m_size) % m_capacity] = sample;
+        m_size++;
+        return true;
+    }
+
+    // Returns the number of samples taken, the rest is dropped
+    uint16_t push(const uint8_t *samples, uint16_t count)
+    {
+        uint16_t pushed = 0;
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            if (push(samples[i]))
+            {
+                pushed++;
+            }
+        }
+
+        return pushed;
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    [[nodiscard]] uint16_t size() const
+    {
+        return m_size;
+    }
+
+    [[nodiscard]] uint16_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    [[nodiscard]] uint32_t droppedSamples() const
+    {
+        return m_droppedSamples;
+    }
+
+private:
+    friend class NextionInterfaceBase;
+
+    const NextionComponent *m_waveform;
+    uint8_t m_channel;
+    uint8_t *m_buffer;
+    uint16_t m_capacity;
+    uint16_t m_head = 0;
+    uint16_t m_size = 0;
+    uint32_t m_droppedSamples = 0;
+    NextionWaveformChannel *m_next = nullptr;
+
+    // Number of samples stored contiguously from the oldest one
+    [[nodiscard]] uint16_t contiguousSize() const
+    {
+        return m_head + m_size <= m_capacity ? m_size : m_capacity - m_head;
+    }
+
+    void consume(uint16_t count)
+    {
+        m_head = (m_head + count) % m_capacity;
+        m_size -= count;
+    }
+};